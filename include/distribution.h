@@ -0,0 +1,58 @@
+#ifndef DISTRIBUTION_H
+#define DISTRIBUTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+*    Sampling distributions for delays and packet sizes.
+*    Every distribution is sampled in O(1) from a single rand() draw, the same cost as random_delay:
+*    - empirical histograms use a Walker/Vose alias table (pick a bin, then uniform inside the bin)
+*    - parametric laws use a precomputed inverse-CDF table with linear interpolation; the first and last
+*      interval (p < 1/N, p >= 1-1/N) evaluate the exact quantile instead, so heavy tails are not cut off
+*      (the only limit left is the resolution of rand(), p <= 1 - 2^-32 with the usual 31-bit RAND_MAX)
+*/
+
+#define DIST_TABLE_SIZE 8192    // intervals of an inverse-CDF table
+// largest sample the simulator turns into a delay or a size (2^53, still exact in a double);
+// heavy tails can exceed any integer type, so callers clamp to this before rounding
+#define DIST_SAMPLE_MAX 9007199254740992.0
+
+typedef enum {
+    DIST_EMPIRICAL,    // histogram, alias table
+    DIST_EXPONENTIAL,    // mean
+    DIST_PARETO,    // scale (minimum), shape
+    DIST_LOGNORMAL,    // mu, sigma of the underlying normal
+    DIST_WEIBULL    // scale, shape
+} DistributionKind;
+
+typedef struct Distribution {
+    DistributionKind kind;
+    size_t n;    // bins (empirical) or table intervals (parametric)
+    double *prob;    // alias: probability of keeping column i
+    uint32_t *alias;    // alias: the other bin of column i
+    double *lower;    // alias: lower edge of each bin
+    double *width;    // alias: width of each bin (0 = a single value)
+    double *table;    // inverse CDF at n + 1 equally spaced quantiles (ends unused, see above)
+    double param1, param2;    // parameters of the law, for the exact quantile in the outer intervals
+    char name[64];    // for the statistics output
+} Distribution;
+
+// empirical: bins [lower[i], upper[i]] with relative weights (upper may equal lower for a point mass)
+Distribution *distribution_create_histogram(const double *lower, const double *upper, const double *weight, size_t n);
+// histogram file: one bin per line, "lower upper weight" or "value weight" and nothing else;
+// blank lines and lines starting with '#' are skipped, any other line is an error (file:line on stderr)
+Distribution *distribution_load_histogram(const char *path);
+
+// parametric laws
+Distribution *distribution_create_exponential(double mean);
+Distribution *distribution_create_pareto(double scale, double shape);
+Distribution *distribution_create_lognormal(double mu, double sigma);
+Distribution *distribution_create_weibull(double scale, double shape);
+
+void distribution_destroy(Distribution *dist);
+
+// draw one sample (uses rand(), like the rest of the simulator)
+double distribution_sample(const Distribution *dist);
+
+#endif // DISTRIBUTION_H
@@ -12,4 +12,14 @@ extern struct Event *current_event; // pointer to event being processed
 // Run the event loop until no events remain
 void event_loop_run(EventScheduler *scheduler);
 
+// Run events whose time <= until_time, at most max_events of them (0 = no limit).
+// Stops early if event_loop_stop() is called. Returns the number of events processed.
+uint64_t event_loop_run_until(EventScheduler *scheduler, uint64_t until_time, uint64_t max_events);
+
+// Execute a single already-popped event and destroy it (shared by all loop flavours)
+void event_loop_dispatch(Event *ev);
+
+// Ask the running loop to return after the current event (safe to call from a task)
+void event_loop_stop(void);
+
 #endif // EVENT_LOOP_H
@@ -22,4 +22,12 @@ Event *event_scheduler_pop(EventScheduler *scheduler);
 // printer
 void event_scheduler_print(EventScheduler *scheduler);
 
+// destroy every pending event together with its packet (the scheduler itself stays usable)
+void event_scheduler_clear(EventScheduler *scheduler);
+
+// deep copy: every pending event (and its packet) is duplicated, contexts are translated by remap_context
+// (NULL = keep them); used to clone a whole simulation state
+EventScheduler *event_scheduler_clone(const EventScheduler *scheduler,
+                                      void *(*remap_context)(void *context, void *arg), void *arg);
+
 #endif // EVENT_SCHEDULER_H
@@ -7,11 +7,17 @@
 
 typedef enum {
     SENDER_FIXED_INTERVAL,    // Fixed interval sending
-    SENDER_EXPONENTIAL    // Exponentially distributed sending
+    SENDER_EXPONENTIAL,    // Exponentially distributed sending
+    SENDER_TRACE    // Replay of a binary arrival trace (see trace.h)
 } SenderMode;
 
+struct TraceFile;
+struct Distribution;
+struct Topology;
+struct ForwardingTable;
+
 typedef struct SenderContext {    // Context for the sender
-    int packets_sent;    // Total packets sent
+    uint64_t packets_sent;    // Total packets sent
     uint64_t interval;    // Interval for fixed sending
     uint64_t finish_time;    // Time to stop sending (simulation end time)
     SenderMode mode;    // Sending mode (fixed or exponential)
@@ -19,18 +25,33 @@ typedef struct SenderContext {    // Context for the sender
     struct NetworkContext *network;    // Reference to network context
     uint64_t packet_size;          // size of each generated packet
     uint64_t total_bytes_sent;     // accumulated bytes sent
+    struct TraceFile *trace;       // trace replayed in SENDER_TRACE mode (borrowed, not closed by the sender)
+    struct Distribution *size_dist;    // packet size distribution, NULL = constant packet_size (borrowed)
 } SenderContext;
 
 typedef struct NetworkContext {
-    int packets_forwarded;
+    uint64_t packets_forwarded;
     uint64_t min_delay;    // Minimum network delay
     uint64_t max_delay;    // Maximum network delay
     struct ReceiverContext *receiver;    // Reference to receiver context
     uint64_t total_bytes_forwarded; // accumulated bytes forwarded
+    struct Distribution *delay_dist;    // delay distribution, NULL = uniform min_delay..max_delay (borrowed)
+    struct MultiHopContext *multihop;    // if set, packets enter the multi-hop network instead of going to receiver
 } NetworkContext;
 
+typedef struct MultiHopContext {    // Multi-hop network stage, forwarding hop by hop with a precomputed table
+    const struct Topology *topology;    // borrowed
+    const struct ForwardingTable *fib;    // borrowed
+    uint32_t ingress;    // node where packets from the access network enter
+    struct ReceiverContext *receiver;    // Reference to receiver context (packets that reached their destination)
+    uint64_t packets_routed;    // packets that entered the multi-hop network
+    uint64_t packets_delivered;
+    uint64_t packets_dropped;    // destination unreachable
+    uint64_t total_hops;    // hops of delivered packets
+} MultiHopContext;
+
 typedef struct ReceiverContext {
-    int packets_received;
+    uint64_t packets_received;
     uint64_t last_receive_time;    // Timestamp of last received packet
     uint64_t time_between_packets;    // Time between last two packets
     int first_packet;    // Flag to indicate if it's the first packet received
@@ -40,20 +61,30 @@ typedef struct ReceiverContext {
 } ReceiverContext;
 
 extern EventScheduler *global_scheduler;    // Global event scheduler. Defined in main.c, used for scheduling events across tasks
+extern int network_sim_verbose;    // 1 (default) prints a line per sender/network/receiver event, 0 keeps the tasks silent
 
 /*
 *    these functions are for creating, destroying, and handling tasks for sender, network, and receiver components
 */
 SenderContext *sender_create(uint64_t interval, uint64_t finish_time, SenderMode mode, double lambda, uint64_t packet_size);
 void sender_destroy(SenderContext *sender);
+void sender_set_trace(SenderContext *sender, struct TraceFile *trace);    // switch to SENDER_TRACE mode
+uint64_t sender_first_send_time(SenderContext *sender);    // time of the initial sender event
+void sender_set_size_distribution(SenderContext *sender, struct Distribution *size_dist);
 void sender_task(void *context);
 void sender_print_stats(SenderContext *sender);
 
 NetworkContext *network_create(uint64_t min_delay, uint64_t max_delay);
 void network_destroy(NetworkContext *network);
+void network_set_delay_distribution(NetworkContext *network, struct Distribution *delay_dist);
 void network_task(void *context);
 void network_print_stats(NetworkContext *network);
 
+MultiHopContext *multihop_create(const struct Topology *topology, const struct ForwardingTable *fib, uint32_t ingress);
+void multihop_destroy(MultiHopContext *multihop);
+void multihop_task(void *context);
+void multihop_print_stats(MultiHopContext *multihop);
+
 ReceiverContext *receiver_create(void);
 void receiver_destroy(ReceiverContext *receiver);
 void receiver_task(void *context);
@@ -62,5 +93,19 @@ void receiver_print_stats(ReceiverContext *receiver);
 void run_network_simulation(uint64_t sender_interval, uint64_t finish_time, SenderMode mode, double lambda, uint64_t net_min_delay, uint64_t net_max_delay, uint64_t packet_size);
 // the main inlet function to run the network simulation with specified parameters
 
+void run_trace_simulation(const char *trace_path, uint64_t finish_time, uint64_t net_min_delay, uint64_t net_max_delay);
+// same as above, but arrivals and sizes come from a binary trace file (finish_time 0 = whole trace)
+
+void run_distribution_simulation(uint64_t sender_interval, uint64_t finish_time, struct Distribution *delay_dist, struct Distribution *size_dist);
+// fixed-interval sender whose packet sizes and network delays are drawn from the given distributions
+
+void run_multihop_simulation(uint64_t sender_interval, uint64_t finish_time, uint64_t net_min_delay, uint64_t net_max_delay,
+                             const struct Topology *topology, const struct ForwardingTable *fib, uint32_t ingress);
+// fixed-interval sender, access network, then hop-by-hop forwarding to a random destination of fib
+
+void run_realtime_simulation(uint64_t sender_interval, uint64_t finish_time, uint64_t net_min_delay, uint64_t net_max_delay,
+                             uint64_t ns_per_tick, uint64_t inject_interval_ns);
+// demo1-like chain paced against the wall clock, with a second thread injecting external packets every inject_interval_ns
+
 #endif
 
@@ -4,21 +4,25 @@
 #include <stdint.h>
 
 typedef struct Packet {
-    int id;    // Unique packet identifier
+    uint64_t id;    // Unique packet identifier
     uint64_t creation_time;    // Timestamp when the packet was created
     uint64_t size;    // Size of the packet in bytes
+    uint32_t node;    // Current node in the multi-hop network
+    uint32_t dest_slot;    // Destination slot in the forwarding table (see routing.h)
+    uint32_t hops;    // Hops taken so far
     // char* payload; // Optional future extension
 } Packet;
 
 // Constructor / destructor
-Packet *packet_create(int id, uint64_t creation_time, uint64_t size);    // create and initialize a new packet
+Packet *packet_create(uint64_t id, uint64_t creation_time, uint64_t size);    // create and initialize a new packet
 void packet_destroy(Packet *pkt);    // destroy a packet and free memory
 
 // Accessors (needed by network_sim.c)
 // these functions are to avoid the warning of implicit declaration (putain C99)
-int packet_get_id(const Packet *pkt);
+uint64_t packet_get_id(const Packet *pkt);    // 0 for NULL (ids start at 1)
 uint64_t packet_get_creation_time(const Packet *pkt);
 uint64_t packet_get_size(const Packet *pkt);
 void packet_set_size(Packet *pkt, uint64_t new_size); // optional mutator
+void packet_set_route(Packet *pkt, uint32_t node, uint32_t dest_slot); // enter the multi-hop network
 
 #endif
@@ -0,0 +1,48 @@
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <stdint.h>
+#include "event_scheduler.h"
+
+/*
+*    Process-interaction layer: a model is written as a plain loop that calls sim_wait(dt) or sim_recv()
+*    instead of a chain of callbacks that re-create their own next event (like sender_task).
+*    Every process runs on its own coroutine stack; suspending it pushes an ordinary Event into the
+*    EventScheduler, and the event loop resumes it when that event fires.
+*    - stacks are PROCESS_STACK_SIZE bytes with a PROT_NONE guard page below them and are pooled for reuse
+*    - on x86-64 the context switch is six register pushes and a stack swap, no signal mask syscall like ucontext
+*    sim_wait / sim_recv / sim_self may only be called from inside a process body.
+*    Lifetime: the stack goes back to the pool as soon as the body returns; the SimProcess record is freed once
+*    the body has returned, the spawner has called process_release and no sim_send to it is still queued.
+*    Until process_release the handle stays valid (process_finished, sim_send); a model that spawns a process
+*    per packet or flow releases the handle right away (or when done with it) and memory stays bounded.
+*/
+
+#define PROCESS_STACK_SIZE (64 * 1024)
+
+typedef struct SimProcess SimProcess;    // opaque, owned by the process layer
+
+typedef void (*ProcessBody)(void *arg);
+
+// start body(arg) as a process at start_time; NULL if the stack or the event could not be allocated
+SimProcess *process_spawn(EventScheduler *scheduler, uint64_t start_time, ProcessBody body, void *arg);
+
+// suspend the calling process for dt time units; returns -1 (without waiting) if the wake-up cannot be scheduled
+int sim_wait(uint64_t dt);
+
+// suspend the calling process until a message is in its mailbox, and return it
+void *sim_recv(void);
+
+// deliver payload to dst's mailbox after delay time units (callable from processes and ordinary tasks)
+int sim_send(SimProcess *dst, uint64_t delay, void *payload);
+
+SimProcess *sim_self(void);
+// 1 once the body has returned (the handle must not have been released yet)
+int process_finished(const SimProcess *process);
+// give up the handle returned by process_spawn; the record is freed when the process is done with it
+void process_release(SimProcess *process);
+
+// free every remaining process, undelivered mailbox entry and pooled stack (events still queued must be drained first)
+void process_shutdown(void);
+
+#endif // PROCESS_H
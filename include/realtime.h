@@ -0,0 +1,82 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "event.h"
+#include "event_scheduler.h"
+
+/*
+*    Real-time paced event loop, for hardware-in-the-loop use where simulated time tracks wall-clock time.
+*    - each event runs at its wall-clock deadline: start + (time - start_time) * ns_per_tick
+*      (sleep while the deadline is far, spin for the last spin_ns; the thread's timer slack is lowered to 1 ns
+*      during realtime_run so that the sleep does not overshoot into the spin window)
+*    - other threads hand in events through a lock-free multi-producer single-consumer queue
+*      (Vyukov's intrusive MPSC list) and wake the sleeping loop (futex on Linux), which merges the queue
+*      into the EventScheduler
+*    - statistics are kept apart for the two kinds of events:
+*      scheduled events (deadline still ahead when known to the loop): deadline misses, mean / stddev / max lateness
+*      injected events already due on arrival (e.g. stamped with realtime_now()): injection-to-dispatch delay
+*/
+
+typedef struct RtInjectNode {
+    Event *event;
+    uint64_t injected_wall_ns;    // wall clock at realtime_inject
+    _Atomic(struct RtInjectNode *) next;
+} RtInjectNode;
+
+// running mean / variance (Welford) and maximum of a delay in ns
+typedef struct RtDelayStats {
+    uint64_t count;
+    uint64_t max_ns;
+    double mean_ns;
+    double m2;
+} RtDelayStats;
+
+typedef struct RealtimeLoop {
+    _Atomic(RtInjectNode *) tail;    // producers swap themselves in here
+    RtInjectNode *head;    // consumer side, only touched by the loop thread
+    RtInjectNode stub;
+    RtInjectNode *due_head;    // merged injections whose deadline had already passed, in arrival order
+    RtInjectNode *due_tail;    // (loop thread only; dispatched before later scheduler events)
+
+    uint64_t ns_per_tick;    // wall-clock nanoseconds per simulation time unit
+    uint64_t spin_ns;    // busy-wait this close to a deadline instead of sleeping
+    uint64_t max_sleep_ns;    // sleep slice where no wake-up primitive is available
+    uint64_t miss_tolerance_ns;    // lateness above this counts as a deadline miss
+
+    atomic_int stop;
+    _Atomic uint32_t wake_seq;    // bumped by every injection and by realtime_stop (the futex word)
+    atomic_int sleeping;    // the loop is (about to be) blocked on wake_seq
+    _Atomic uint64_t start_wall_ns;    // wall clock at start_time (0 = not started)
+    _Atomic uint64_t start_time;
+
+    // statistics (loop thread only)
+    uint64_t events;    // events executed
+    uint64_t injected;    // events merged from the queue
+    uint64_t late_injections;    // injected with a time already in the past (moved to now)
+    uint64_t dropped;    // injected but the scheduler was full
+    uint64_t misses;    // scheduled events executed more than miss_tolerance_ns late
+    RtDelayStats lateness;    // scheduled events: dispatch - deadline
+    RtDelayStats injection_delay;    // injections due on arrival: dispatch - realtime_inject
+} RealtimeLoop;
+
+// ns_per_tick: wall-clock nanoseconds per time unit (e.g. 1000000 = one unit per millisecond)
+RealtimeLoop *realtime_create(uint64_t ns_per_tick);
+// destroys pending injected events (and their packets)
+void realtime_destroy(RealtimeLoop *rt);
+
+// thread-safe and lock-free (apart from malloc of the node): hand an event to the loop and wake it; 0 on success
+int realtime_inject(RealtimeLoop *rt, Event *ev);
+// thread-safe: simulation time matching the wall clock right now (0 before realtime_run starts)
+uint64_t realtime_now(RealtimeLoop *rt);
+// thread-safe: make realtime_run return as soon as possible
+void realtime_stop(RealtimeLoop *rt);
+
+// run paced until the simulation clock reaches until_time or realtime_stop is called
+// (an empty scheduler keeps waiting for injections); returns the number of events executed
+uint64_t realtime_run(RealtimeLoop *rt, EventScheduler *scheduler, uint64_t until_time);
+
+void realtime_print_stats(RealtimeLoop *rt);
+
+#endif // REALTIME_H
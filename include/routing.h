@@ -0,0 +1,59 @@
+#ifndef ROUTING_H
+#define ROUTING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+*    Topologies and forwarding tables for the multi-hop network stage.
+*    - Topology: directed graph in CSR form, the edges of node u are row_start[u] .. row_start[u + 1] - 1
+*    - ForwardingTable: shortest-path next hops for a set of destination nodes, computed once at setup
+*      (one Dijkstra per destination on the reversed graph, destinations spread over threads).
+*      The table is one flat row-major array indexed by (node, destination slot) holding the next node together
+*      with the delay of the link to it, so a hop is a single 8-byte load with no follow-up lookups in the
+*      topology, and a node's row for all destinations shares a few cache lines.
+*      Only the chosen destinations get a column, which keeps 10^5+ node graphs at n_nodes * n_dests * 8 bytes.
+*/
+
+#define ROUTE_NONE UINT32_MAX    // no next node: the node is the destination itself or cannot reach it
+#define TOPOLOGY_MAX_NODES (1u << 24)    // node id limit of topology_load when the file has no "nodes N" line
+
+typedef struct Topology {
+    uint32_t n_nodes;
+    uint32_t n_edges;
+    uint32_t *row_start;    // n_nodes + 1 entries
+    uint32_t *edge_to;    // head of each edge
+    uint32_t *edge_delay;    // link delay of each edge
+} Topology;
+
+typedef struct RouteEntry {
+    uint32_t next;    // next node towards the destination, or ROUTE_NONE
+    uint32_t delay;    // delay of the link to next
+} RouteEntry;
+
+typedef struct ForwardingTable {
+    uint32_t n_nodes;
+    uint32_t n_dests;
+    uint32_t *dests;    // node id of each destination slot
+    RouteEntry *next_hop;    // [node * n_dests + slot] = hop towards dests[slot]
+} ForwardingTable;
+
+// build a topology from n_edges directed edges (from[i] -> to[i] with delay[i])
+Topology *topology_create(uint32_t n_nodes, const uint32_t *from, const uint32_t *to, const uint32_t *delay, uint32_t n_edges);
+// edge list file: an optional "nodes N" line, then one directed edge "from to delay" per line (delay > 0, list both
+// directions for a duplex link); blank and '#' lines are skipped, any other line is an error (file:line on stderr)
+Topology *topology_load(const char *path);
+// connected random graph: a bidirectional ring plus random bidirectional chords up to about `degree` links per node
+Topology *topology_create_random(uint32_t n_nodes, uint32_t degree, uint32_t min_delay, uint32_t max_delay);
+void topology_destroy(Topology *topo);
+
+// precompute next hops towards each of the n_dests destination nodes (n_threads 0 = one per online CPU)
+ForwardingTable *forwarding_table_build(const Topology *topo, const uint32_t *dests, uint32_t n_dests, int n_threads);
+void forwarding_table_destroy(ForwardingTable *fib);
+
+// the per-hop lookup
+static inline RouteEntry forwarding_next_hop(const ForwardingTable *fib, uint32_t node, uint32_t slot) {
+    return fib->next_hop[(size_t)node * fib->n_dests + slot];
+}
+
+#endif // ROUTING_H
@@ -0,0 +1,123 @@
+#ifndef SDES_H
+#define SDES_H
+
+/*
+*    libsdes - the embeddable interface of the simulator (build/libsdes.a, build/libsdes.so)
+*    A harness creates a simulation, runs it piece by piece (until a time or for a number of events),
+*    reads the statistics directly, injects more events and resumes, all in-process.
+*    The simulator core uses global state (clock, scheduler), so only one simulation may be running
+*    at a time, but several may exist and be advanced alternately from the same thread.
+*    This header is self-contained: the simulator's own structs stay behind opaque handles, and only the
+*    functions declared here (marked SDES_API) are exported from libsdes.so; everything else is built hidden.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define SDES_API __attribute__((visibility("default")))
+#else
+#define SDES_API
+#endif
+
+typedef struct SdesSim SdesSim;    // opaque handle
+typedef struct Distribution SdesDistribution;    // opaque handle, see the sdes_distribution_* functions
+
+// sending mode of the built-in sender
+typedef enum {
+    SDES_SENDER_FIXED_INTERVAL,    // one packet every interval
+    SDES_SENDER_EXPONENTIAL,    // exponentially distributed gaps with rate lambda
+    SDES_SENDER_TRACE    // replay of a binary arrival trace
+} SdesSenderMode;
+
+// a task of an injected event, called with its context at the event's time
+typedef void (*SdesTask)(void *context);
+
+/*
+*    SdesConfig and SdesStats are allocated by the caller and grow between releases, so both carry their size:
+*    sdes_config_default / sdes_get_stats are macros that pass sizeof() of the header the harness was built with,
+*    and the library only touches that many bytes (newer fields keep their defaults).
+*    New fields are only ever appended.
+*/
+
+typedef struct SdesConfig {
+    size_t size;               // sizeof(SdesConfig) of the caller, set by sdes_config_default
+    SdesSenderMode mode;       // sending mode of the built-in sender
+    uint64_t interval;         // interval for fixed sending
+    uint64_t finish_time;      // time to stop sending (0 = the sender is not started)
+    double lambda;             // arrival rate for exponential mode
+    uint64_t min_delay;        // minimum network delay
+    uint64_t max_delay;        // maximum network delay
+    uint64_t packet_size;      // size of each generated packet
+    size_t capacity;           // scheduler capacity (0 = 10000 like run_network_simulation)
+    unsigned int seed;         // seed for rand() (0 = leave the generator alone)
+    int verbose;               // 1 keeps the per-event log lines of network_sim.c, 0 silences them
+    const char *trace_path;    // binary trace replayed when mode == SDES_SENDER_TRACE
+    SdesDistribution *delay_dist;    // network delay distribution, NULL = uniform min_delay..max_delay (borrowed)
+    SdesDistribution *size_dist;     // packet size distribution, NULL = constant packet_size (borrowed)
+} SdesConfig;
+
+typedef struct SdesStats {
+    size_t size;                    // sizeof(SdesStats) of the caller, set by sdes_get_stats
+    uint64_t sim_time;              // current simulation time
+    uint64_t events_processed;      // events executed since sdes_create
+    size_t pending_events;          // events still in the scheduler
+    uint64_t packets_sent;
+    uint64_t total_bytes_sent;
+    uint64_t packets_forwarded;
+    uint64_t total_bytes_forwarded;
+    uint64_t packets_received;
+    uint64_t total_bytes_received;
+    uint64_t total_latency;         // sum of (receive_time - creation_time)
+    uint64_t last_latency;
+    uint64_t packets_injected;      // packets handed in by sdes_inject_packet
+} SdesStats;
+
+// the smallest sizes the library accepts: the layouts above, as first released
+// (SdesStats: the 64-bit counter layout; the older one with int packet counters ended at last_latency
+// with the same size, so the minimum includes packets_injected and such harnesses are rejected)
+#define SDES_CONFIG_SIZE_MIN (offsetof(SdesConfig, size_dist) + sizeof(SdesDistribution *))
+#define SDES_STATS_SIZE_MIN (offsetof(SdesStats, packets_injected) + sizeof(uint64_t))
+
+// fill cfg with the parameters of demo1 (fixed interval 100, finish 2000, delay 10-50, 512 bytes, silent)
+#define sdes_config_default(cfg) sdes_config_init((cfg), sizeof(SdesConfig))
+// the function behind sdes_config_default: fills the first `size` bytes; returns 0, or -1 for an unknown size
+SDES_API int sdes_config_init(SdesConfig *cfg, size_t size);
+
+// create / destroy a simulation; create schedules the first sender event if finish_time > 0
+// (in SDES_SENDER_TRACE mode finish_time 0 means the whole trace); NULL if cfg->size is not a known layout
+SDES_API SdesSim *sdes_create(const SdesConfig *cfg);
+SDES_API void sdes_destroy(SdesSim *sim);
+
+// inject an event that calls task(context) at the given time (not before sdes_now, also when called from a
+// running task); returns 0 on success, -1 on error
+SDES_API int sdes_inject_event(SdesSim *sim, uint64_t time, SdesTask task, void *context);
+// inject a packet of the given size into the network stage at the given time
+SDES_API int sdes_inject_packet(SdesSim *sim, uint64_t time, uint64_t size);
+
+// run all events with time <= until_time; returns the number of events executed
+SDES_API uint64_t sdes_run_until(SdesSim *sim, uint64_t until_time);
+// run at most max_events events; returns the number of events executed
+SDES_API uint64_t sdes_run_events(SdesSim *sim, uint64_t max_events);
+// run until the scheduler is empty
+SDES_API uint64_t sdes_run(SdesSim *sim);
+// from inside a task: make the current sdes_run* call return after this event (resume by calling it again)
+SDES_API void sdes_pause(SdesSim *sim);
+
+// the simulation clock; inside a task during sdes_run* this is the time of the running event
+SDES_API uint64_t sdes_now(const SdesSim *sim);
+#define sdes_get_stats(sim, stats) sdes_get_stats_sized((sim), (stats), sizeof(SdesStats))
+// the function behind sdes_get_stats: fills the first `size` bytes; returns 0, or -1 for an unknown size
+SDES_API int sdes_get_stats_sized(const SdesSim *sim, SdesStats *stats, size_t size);
+
+// distributions for SdesConfig.delay_dist / size_dist; NULL on bad parameters or a bad file
+// histogram file: one bin per line, "lower upper weight" or "value weight" and nothing else;
+// blank lines and lines starting with '#' are skipped, any other line is an error (file:line on stderr)
+SDES_API SdesDistribution *sdes_distribution_load_histogram(const char *path);
+SDES_API SdesDistribution *sdes_distribution_exponential(double mean);
+SDES_API SdesDistribution *sdes_distribution_pareto(double scale, double shape);
+SDES_API SdesDistribution *sdes_distribution_lognormal(double mu, double sigma);
+SDES_API SdesDistribution *sdes_distribution_weibull(double scale, double shape);
+SDES_API void sdes_distribution_destroy(SdesDistribution *dist);
+
+#endif // SDES_H
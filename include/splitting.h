@@ -0,0 +1,46 @@
+#ifndef SPLITTING_H
+#define SPLITTING_H
+
+#include <stdint.h>
+
+/*
+*    Rare-event estimation with RESTART (multilevel splitting).
+*    Model: a single-server queue with Poisson arrivals (lambda), exponential service (mu) and room for
+*    `buffer` packets, simulated on the EventScheduler. One busy cycle starts with one packet in the queue;
+*    the rare event is an overflow: the queue fills up (the next arrival would be lost) before it empties again.
+*    Importance function: queue occupancy. Thresholds T_1 < ... < T_m = buffer are spread evenly above 1.
+*    Whenever a trajectory crosses T_i upwards (i < m), the whole simulation state (queue + scheduler) is cloned into
+*    `splits` - 1 retrials; retrials are killed when they fall back below the threshold they were born at,
+*    the original carries on. Every overflow then counts with weight splits^-(m-1), which keeps the estimate unbiased.
+*    The variance is estimated from the spread of the independent root cycles.
+*/
+
+typedef struct SplitConfig {
+    double lambda;    // arrival rate
+    double mu;    // service rate
+    uint32_t buffer;    // queue capacity, the rare set is "occupancy reaches buffer"
+    uint32_t n_levels;    // number of thresholds m (clamped to buffer - 1)
+    uint32_t splits;    // trajectories after each crossing (1 = brute force)
+    uint64_t roots;    // independent busy cycles
+    uint64_t max_events;    // stop starting new cycles once this many events ran (0 = no limit)
+    unsigned int seed;    // seed for rand() (0 = leave the generator alone)
+} SplitConfig;
+
+typedef struct SplitResult {
+    double estimate;    // P(overflow before the queue empties | busy cycle starts)
+    double variance;    // variance of the estimate
+    double relative_error;    // sqrt(variance) / estimate
+    double analytic;    // exact value for this M/M/1/K model, for comparison
+    uint64_t roots;    // busy cycles actually simulated
+    uint64_t hits;    // trajectories that reached the rare set
+    uint64_t trajectories;    // roots + retrials
+    uint64_t events;    // events executed
+} SplitResult;
+
+// run the estimator; returns 0 on success, -1 on bad parameters or allocation failure
+int restart_estimate(const SplitConfig *cfg, SplitResult *result);
+
+// print one result block in the style of the other statistics
+void restart_print_result(const char *label, const SplitConfig *cfg, const SplitResult *result);
+
+#endif // SPLITTING_H
@@ -0,0 +1,11 @@
+#ifndef SYSUTIL_H
+#define SYSUTIL_H
+
+#include <stddef.h>
+
+// small OS helpers shared by the modules that map memory themselves (trace.c, process.c)
+
+// the system page size, queried once (4096 if sysconf fails)
+size_t sys_page_size(void);
+
+#endif // SYSUTIL_H
@@ -0,0 +1,53 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+*    Binary arrival traces for SENDER_TRACE mode.
+*    File layout: one TraceHeader followed by header.count TraceRecords, in the byte order of the host that
+*    wrote it (records are mapped and read in place, without conversion), so a trace file is only portable
+*    between hosts with the same byte order.
+*    Records must be sorted by time (the converter checks it). The file is mmapped and read front to back,
+*    so a trace of billions of records never sits in the scheduler or on the heap.
+*/
+
+#define TRACE_MAGIC "SDESTRC1"
+#define TRACE_READAHEAD_RECORDS (1u << 16)    // records per readahead window (1 MiB)
+
+typedef struct TraceHeader {
+    char magic[8];    // TRACE_MAGIC, not NUL terminated
+    uint64_t count;    // number of records that follow
+} TraceHeader;
+
+typedef struct TraceRecord {
+    uint64_t time;    // arrival timestamp (simulation time units)
+    uint64_t size;    // packet size in bytes
+} TraceRecord;
+
+typedef struct TraceFile {
+    int fd;
+    void *map;    // whole file mapping
+    size_t map_len;
+    const TraceRecord *records;    // first record inside map
+    uint64_t count;
+    uint64_t cursor;    // index of the next record trace_next returns
+    uint64_t advised_until;    // records before this index were already hinted with MADV_WILLNEED
+    uint64_t released_until;    // pages before this record were handed back with MADV_DONTNEED
+} TraceFile;
+
+// open / close a binary trace (NULL on error, message on stderr)
+TraceFile *trace_open(const char *path);
+void trace_close(TraceFile *trace);
+
+// sequential access: peek at / consume the record under the cursor (NULL at end of trace)
+const TraceRecord *trace_peek(TraceFile *trace);
+const TraceRecord *trace_next(TraceFile *trace);
+
+// convert "timestamp,size" CSV lines into a binary trace; blank lines, '#' lines and a first-line header
+// are skipped, any other malformed line is reported with its line number
+// returns the number of records written, or -1 on error
+int64_t trace_convert_csv(const char *csv_path, const char *bin_path);
+
+#endif // TRACE_H
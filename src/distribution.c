@@ -0,0 +1,349 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "distribution.h"
+
+// one uniform draw in [0, 1); the integer part of u * n picks the column, the fraction is reused
+static double uniform01(void) {
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static Distribution *distribution_alloc(DistributionKind kind, size_t n) {
+    Distribution *dist = calloc(1, sizeof(Distribution));
+    if (!dist)
+        return NULL;
+    dist->kind = kind;
+    dist->n = n;
+    return dist;
+}
+
+void distribution_destroy(Distribution *dist) {
+    if (!dist)
+        return;
+    free(dist->prob);
+    free(dist->alias);
+    free(dist->lower);
+    free(dist->width);
+    free(dist->table);
+    free(dist);
+}
+
+/* Vose's alias method...
+* 1. Scales the weights so that the average column holds exactly 1.
+* 2. Splits the columns into "small" (< 1) and "large" (>= 1) worklists.
+* 3. Repeatedly tops up a small column with a piece of a large one; the large one becomes its alias
+*    and goes back to the small list if what is left of it drops below 1.
+* 4. Whatever remains (only rounding errors) is kept with probability 1.
+*/
+static int build_alias_table(Distribution *dist, const double *weight) {
+    size_t n = dist->n;
+    double total = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        if (weight[i] < 0.0)
+            return -1;
+        total += weight[i];
+    }
+    if (total <= 0.0)
+        return -1;
+
+    double *scaled = malloc(sizeof(double) * n);
+    uint32_t *small = malloc(sizeof(uint32_t) * n);
+    uint32_t *large = malloc(sizeof(uint32_t) * n);
+    if (!scaled || !small || !large) {
+        free(scaled);
+        free(small);
+        free(large);
+        return -1;
+    }
+
+    size_t n_small = 0, n_large = 0;
+    for (size_t i = 0; i < n; i++) {
+        scaled[i] = weight[i] * (double)n / total;
+        if (scaled[i] < 1.0)
+            small[n_small++] = (uint32_t)i;
+        else
+            large[n_large++] = (uint32_t)i;
+    }
+
+    while (n_small > 0 && n_large > 0) {
+        uint32_t s = small[--n_small];
+        uint32_t l = large[--n_large];
+        dist->prob[s] = scaled[s];
+        dist->alias[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0)
+            small[n_small++] = l;
+        else
+            large[n_large++] = l;
+    }
+    while (n_large > 0) {
+        uint32_t l = large[--n_large];
+        dist->prob[l] = 1.0;
+        dist->alias[l] = l;
+    }
+    while (n_small > 0) {
+        uint32_t s = small[--n_small];
+        dist->prob[s] = 1.0;
+        dist->alias[s] = s;
+    }
+
+    free(scaled);
+    free(small);
+    free(large);
+    return 0;
+}
+
+Distribution *distribution_create_histogram(const double *lower, const double *upper, const double *weight, size_t n) {
+    if (!lower || !upper || !weight || n == 0 || n > UINT32_MAX)
+        return NULL;
+    for (size_t i = 0; i < n; i++) {
+        if (lower[i] < 0.0 || upper[i] < lower[i])
+            return NULL;
+    }
+
+    Distribution *dist = distribution_alloc(DIST_EMPIRICAL, n);
+    if (!dist)
+        return NULL;
+    dist->prob = malloc(sizeof(double) * n);
+    dist->alias = malloc(sizeof(uint32_t) * n);
+    dist->lower = malloc(sizeof(double) * n);
+    dist->width = malloc(sizeof(double) * n);
+    if (!dist->prob || !dist->alias || !dist->lower || !dist->width) {
+        distribution_destroy(dist);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        dist->lower[i] = lower[i];
+        dist->width[i] = upper[i] - lower[i];
+    }
+    if (build_alias_table(dist, weight) != 0) {
+        distribution_destroy(dist);
+        return NULL;
+    }
+    snprintf(dist->name, sizeof(dist->name), "Empirical (%zu bins)", n);
+    return dist;
+}
+
+// "lower upper weight" or "value weight", each field a finite number, then nothing but whitespace; 0 on success
+static int parse_bin_line(const char *line, double *lower, double *upper, double *weight) {
+    double a, b, c;
+    int end = -1;
+    if (sscanf(line, "%lf %lf %lf %n", &a, &b, &c, &end) == 3 && end >= 0 && line[end] == '\0') {
+        *lower = a;
+        *upper = b;
+        *weight = c;
+    } else if (end = -1, sscanf(line, "%lf %lf %n", &a, &b, &end) == 2 && end >= 0 && line[end] == '\0') {
+        *lower = a;    // a point mass
+        *upper = a;
+        *weight = b;
+    } else {
+        return -1;
+    }
+    return isfinite(*lower) && isfinite(*upper) && isfinite(*weight) ? 0 : -1;
+}
+
+/* the loader...
+* 1. Skips blank lines and comment lines (first non-blank character '#').
+* 2. Parses every other line strictly with parse_bin_line; a malformed line is an error with its line number,
+*    so a typo cannot silently drop or truncate a bin.
+* 3. Leaves the range checks (lower >= 0, upper >= lower, weights) to distribution_create_histogram.
+*/
+Distribution *distribution_load_histogram(const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return NULL;
+    }
+
+    size_t n = 0, capacity = 64;
+    double *lower = malloc(sizeof(double) * capacity);
+    double *upper = malloc(sizeof(double) * capacity);
+    double *weight = malloc(sizeof(double) * capacity);
+    Distribution *dist = NULL;
+    char line[256];
+    size_t line_no = 0;
+
+    while (lower && upper && weight && fgets(line, sizeof(line), in)) {
+        line_no++;
+        if (!strchr(line, '\n') && !feof(in)) {
+            fprintf(stderr, "[Distribution] %s:%zu: line too long\n", path, line_no);
+            goto done;
+        }
+        const char *p = line;
+        while (isspace((unsigned char)*p))
+            p++;
+        if (*p == '\0' || *p == '#')
+            continue;
+
+        double a, b, c;
+        if (parse_bin_line(p, &a, &b, &c) != 0) {
+            fprintf(stderr, "[Distribution] %s:%zu: expected 'lower upper weight' or 'value weight'\n", path, line_no);
+            goto done;
+        }
+
+        if (n == capacity) {
+            capacity *= 2;
+            double *nl = realloc(lower, sizeof(double) * capacity);
+            if (nl) lower = nl;
+            double *nu = realloc(upper, sizeof(double) * capacity);
+            if (nu) upper = nu;
+            double *nw = realloc(weight, sizeof(double) * capacity);
+            if (nw) weight = nw;
+            if (!nl || !nu || !nw)
+                goto done;
+        }
+        lower[n] = a;
+        upper[n] = b;
+        weight[n] = c;
+        n++;
+    }
+
+    dist = distribution_create_histogram(lower, upper, weight, n);
+    if (!dist)
+        fprintf(stderr, "[Distribution] %s: empty or invalid histogram\n", path);
+
+done:
+    fclose(in);
+    free(lower);
+    free(upper);
+    free(weight);
+    return dist;
+}
+
+/* Acklam's rational approximation of the standard normal quantile (relative error < 1.2e-9),
+* good enough for building a lookup table.
+*/
+static double normal_quantile(double p) {
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    const double p_low = 0.02425;
+
+    if (p < p_low) {
+        double q = sqrt(-2.0 * log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > 1.0 - p_low) {
+        double q = sqrt(-2.0 * log(1.0 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+// inverse CDF of the parametric laws
+static double quantile(DistributionKind kind, double p1, double p2, double p) {
+    switch (kind) {
+    case DIST_EXPONENTIAL: return -p1 * log(1.0 - p);
+    case DIST_PARETO: return p1 * pow(1.0 - p, -1.0 / p2);
+    case DIST_LOGNORMAL: return exp(p1 + p2 * normal_quantile(p));
+    case DIST_WEIBULL: return p1 * pow(-log(1.0 - p), 1.0 / p2);
+    case DIST_EMPIRICAL: break;
+    }
+    return 0.0;
+}
+
+// tabulate the quantile function at DIST_TABLE_SIZE + 1 points; the clamped end points are only
+// there to keep the table well defined, distribution_sample never interpolates towards them
+static Distribution *create_parametric(DistributionKind kind, double p1, double p2) {
+    Distribution *dist = distribution_alloc(kind, DIST_TABLE_SIZE);
+    if (!dist)
+        return NULL;
+    dist->param1 = p1;
+    dist->param2 = p2;
+    dist->table = malloc(sizeof(double) * (DIST_TABLE_SIZE + 1));
+    if (!dist->table) {
+        distribution_destroy(dist);
+        return NULL;
+    }
+
+    const double eps = 0.5 / DIST_TABLE_SIZE;
+    for (size_t i = 0; i <= DIST_TABLE_SIZE; i++) {
+        double p = (double)i / DIST_TABLE_SIZE;
+        if (p < eps) p = eps;
+        if (p > 1.0 - eps) p = 1.0 - eps;
+        dist->table[i] = quantile(kind, p1, p2, p);
+    }
+    return dist;
+}
+
+Distribution *distribution_create_exponential(double mean) {
+    if (mean <= 0.0)
+        return NULL;
+    Distribution *dist = create_parametric(DIST_EXPONENTIAL, mean, 0.0);
+    if (dist)
+        snprintf(dist->name, sizeof(dist->name), "Exponential (mean=%g)", mean);
+    return dist;
+}
+
+Distribution *distribution_create_pareto(double scale, double shape) {
+    if (scale <= 0.0 || shape <= 0.0)
+        return NULL;
+    Distribution *dist = create_parametric(DIST_PARETO, scale, shape);
+    if (dist)
+        snprintf(dist->name, sizeof(dist->name), "Pareto (scale=%g, shape=%g)", scale, shape);
+    return dist;
+}
+
+Distribution *distribution_create_lognormal(double mu, double sigma) {
+    if (sigma <= 0.0)
+        return NULL;
+    Distribution *dist = create_parametric(DIST_LOGNORMAL, mu, sigma);
+    if (dist)
+        snprintf(dist->name, sizeof(dist->name), "Lognormal (mu=%g, sigma=%g)", mu, sigma);
+    return dist;
+}
+
+Distribution *distribution_create_weibull(double scale, double shape) {
+    if (scale <= 0.0 || shape <= 0.0)
+        return NULL;
+    Distribution *dist = create_parametric(DIST_WEIBULL, scale, shape);
+    if (dist)
+        snprintf(dist->name, sizeof(dist->name), "Weibull (scale=%g, shape=%g)", scale, shape);
+    return dist;
+}
+
+/* one rand() per sample...
+* x = u * n splits into a column i and a fraction f, both uniform and independent (up to rand() resolution).
+* - alias: f decides between column i and its alias, and f rescaled to [0, 1) places the value inside the bin
+* - table: f interpolates between table[i] and table[i + 1]; in the first and last interval, where the
+*   quantile function is far from linear (and unbounded for the heavy tails), the exact quantile is used,
+*   at u shifted by half a rand() step so that it never hits 0 or 1
+*/
+double distribution_sample(const Distribution *dist) {
+    double x = uniform01() * (double)dist->n;
+    size_t i = (size_t)x;
+    if (i >= dist->n)
+        i = dist->n - 1;
+    double f = x - (double)i;
+
+    if (dist->kind != DIST_EMPIRICAL) {
+        if (i == 0 || i == dist->n - 1)
+            return quantile(dist->kind, dist->param1, dist->param2, x / (double)dist->n + 0.5 / ((double)RAND_MAX + 1.0));
+        return dist->table[i] + f * (dist->table[i + 1] - dist->table[i]);
+    }
+
+    double keep = dist->prob[i];
+    size_t bin;
+    double v;
+    if (f < keep) {
+        bin = i;
+        v = f / keep;
+    } else {
+        bin = dist->alias[i];
+        v = (f - keep) / (1.0 - keep);
+    }
+    return dist->lower[bin] + v * dist->width[bin];
+}
@@ -4,6 +4,20 @@
 uint64_t current_sim_time = 0;
 struct Event *current_event = NULL;
 
+static int stop_requested = 0;    // set by event_loop_stop, cleared when a run starts
+
+void event_loop_dispatch(Event *ev){
+    //update
+    current_sim_time = ev->time;
+    current_event = ev; // This is for pass the packet (not only context) to the task function
+    if (ev->task) {
+        ev->task(ev->context);
+    }
+    current_event = NULL;
+
+    event_destroy(ev);
+}
+
 void event_loop_run(EventScheduler *scheduler){
     if (!scheduler)
         return;
@@ -15,14 +29,44 @@ void event_loop_run(EventScheduler *scheduler){
         if (!ev)
             break;
 
-        //update
-        current_sim_time = ev->time;
-        current_event = ev; // This is for pass the packet (not only context) to the task function
-        if (ev->task) {
-            ev->task(ev->context);
-        }
-        current_event = NULL;
+        event_loop_dispatch(ev);
+    }
+}
+
+/* the incremental version of event_loop_run...
+* 1. Peeks the earliest event and stops if it is later than until_time.
+* 2. Otherwise pops and dispatches it, exactly like event_loop_run.
+* 3. Stops after max_events events (if not 0) or when a task calls event_loop_stop().
+* 4. If the loop ran dry of events <= until_time without being interrupted, the clock is moved to until_time,
+*    so that a later run continues from there (UINT64_MAX means "no time limit" and leaves the clock alone).
+*/
+uint64_t event_loop_run_until(EventScheduler *scheduler, uint64_t until_time, uint64_t max_events){
+    if (!scheduler)
+        return 0;
+
+    uint64_t processed = 0;
+    stop_requested = 0;
 
-        event_destroy(ev);
+    while (scheduler->size > 0 && !stop_requested) {
+        if (max_events && processed >= max_events)
+            return processed;
+        if (scheduler->heap[0]->time > until_time)
+            break;
+
+        Event *ev = event_scheduler_pop(scheduler);
+        if (!ev)
+            break;
+
+        event_loop_dispatch(ev);
+        processed++;
     }
+
+    if (!stop_requested && until_time != UINT64_MAX && current_sim_time < until_time)
+        current_sim_time = until_time;
+    stop_requested = 0;
+    return processed;
+}
+
+void event_loop_stop(void){
+    stop_requested = 1;
 }
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "event_scheduler.h"
+#include "packet.h"
 
 //switch two events
 static void swap(Event **a, Event **b) {
@@ -104,3 +105,41 @@ void event_scheduler_print(EventScheduler *scheduler){
                scheduler->heap[i]->type);
     }
 }
+
+
+void event_scheduler_clear(EventScheduler *scheduler){
+    if (!scheduler) return;
+    for (size_t i = 0; i < scheduler->size; i++) {
+        packet_destroy(scheduler->heap[i]->packet);
+        event_destroy(scheduler->heap[i]);
+    }
+    scheduler->size = 0;
+}
+
+//the heap array is copied slot by slot, so the copy is a valid heap without any sifting
+EventScheduler *event_scheduler_clone(const EventScheduler *scheduler,
+                                      void *(*remap_context)(void *context, void *arg), void *arg){
+    if (!scheduler) return NULL;
+    EventScheduler *copy = event_scheduler_create(scheduler->capacity);
+    if (!copy) return NULL;
+
+    for (size_t i = 0; i < scheduler->size; i++) {
+        const Event *ev = scheduler->heap[i];
+        Packet *pkt = NULL;
+        if (ev->packet) {
+            pkt = packet_create(ev->packet->id, ev->packet->creation_time, ev->packet->size);
+            if (pkt) *pkt = *ev->packet;
+        }
+        void *context = remap_context ? remap_context(ev->context, arg) : ev->context;
+        Event *dup = event_create(ev->time, ev->type, ev->task, context, pkt);
+        if (!dup || (ev->packet && !pkt)) {
+            packet_destroy(pkt);
+            event_destroy(dup);
+            event_scheduler_clear(copy);
+            event_scheduler_destroy(copy);
+            return NULL;
+        }
+        copy->heap[copy->size++] = dup;
+    }
+    return copy;
+}
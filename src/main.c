@@ -1,10 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <ucontext.h>
 #include "event.h"
 #include "event_scheduler.h"
 #include "event_loop.h"
 #include "network_sim.h"
+#include "sdes.h"
+#include "trace.h"
+#include "distribution.h"
+#include "process.h"
+#include "routing.h"
+#include "splitting.h"
 
 // A simple test task
 void test_task(void *context) {
@@ -45,6 +53,290 @@ void run_simple_test(void) {
     event_scheduler_destroy(scheduler);
 }
 
+static void print_sdes_stats(const char *label, const SdesSim *sim) {
+    SdesStats st;
+    sdes_get_stats(sim, &st);
+    printf("[%s] time=%llu events=%llu pending=%zu sent=%llu forwarded=%llu received=%llu avg_latency=%llu\n",
+           label, (unsigned long long)st.sim_time, (unsigned long long)st.events_processed, st.pending_events,
+           (unsigned long long)st.packets_sent, (unsigned long long)st.packets_forwarded,
+           (unsigned long long)st.packets_received,
+           (unsigned long long)(st.packets_received ? st.total_latency / st.packets_received : 0));
+}
+
+// Drive demo1 through libsdes in slices, the way an in-process harness would
+void run_embed_demo(void) {
+    printf("\n=== Running libsdes Embedding Demo ===\n");
+
+    SdesConfig cfg;
+    sdes_config_default(&cfg);
+    cfg.seed = 42;
+
+    SdesSim *sim = sdes_create(&cfg);
+    if (!sim) {
+        fprintf(stderr, "Failed to create simulation!\n");
+        return;
+    }
+
+    sdes_run_until(sim, 500);
+    print_sdes_stats("run_until 500", sim);
+
+    sdes_run_events(sim, 10);
+    print_sdes_stats("run_events 10", sim);
+
+    // a burst of extra traffic on top of the sender
+    for (uint64_t t = sdes_now(sim); t < sdes_now(sim) + 50; t += 10)
+        sdes_inject_packet(sim, t, 1500);
+    sdes_run_until(sim, 1000);
+    print_sdes_stats("inject + run_until 1000", sim);
+
+    sdes_run(sim);
+    print_sdes_stats("run to completion", sim);
+
+    sdes_destroy(sim);
+}
+
+/* demo4: lognormal delays and a bimodal packet size mix, unless histogram files are given
+* histogram files hold one bin per line: "lower upper weight" or "value weight"
+*/
+void run_distribution_demo(const char *delay_hist, const char *size_hist) {
+    static const double size_values[] = { 64, 576, 1500 };
+    static const double size_weights[] = { 0.5, 0.1, 0.4 };
+
+    Distribution *delay_dist = delay_hist ? distribution_load_histogram(delay_hist)
+                                          : distribution_create_lognormal(3.0, 0.5);
+    Distribution *size_dist = size_hist ? distribution_load_histogram(size_hist)
+                                        : distribution_create_histogram(size_values, size_values, size_weights, 3);
+    if (!delay_dist || !size_dist) {
+        fprintf(stderr, "Failed to create distributions!\n");
+    } else {
+        run_distribution_simulation(100, 2000, delay_dist, size_dist);
+    }
+
+    distribution_destroy(delay_dist);
+    distribution_destroy(size_dist);
+}
+
+// wall clock for the timing outputs
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* demo5: multi-hop routing over a generated graph (or an edge list file)
+* destinations are spread evenly over the node ids, packets enter at node 0
+*/
+void run_routing_demo(const char *topology_arg, uint32_t n_dests) {
+    Topology *topo;
+    if (topology_arg && (topology_arg[0] < '0' || topology_arg[0] > '9')) {
+        topo = topology_load(topology_arg);
+    } else {
+        uint32_t n_nodes = topology_arg ? (uint32_t)strtoul(topology_arg, NULL, 10) : 100000;
+        srand(time(NULL));
+        topo = topology_create_random(n_nodes, 6, 1, 10);
+    }
+    if (!topo) {
+        fprintf(stderr, "Failed to create topology!\n");
+        return;
+    }
+    if (n_dests == 0 || n_dests > topo->n_nodes)
+        n_dests = topo->n_nodes < 16 ? topo->n_nodes : 16;
+
+    uint32_t *dests = malloc(sizeof(uint32_t) * n_dests);
+    if (!dests) {
+        topology_destroy(topo);
+        return;
+    }
+    for (uint32_t i = 0; i < n_dests; i++)
+        dests[i] = (uint32_t)((uint64_t)i * topo->n_nodes / n_dests + topo->n_nodes / (2 * n_dests));
+
+    double t0 = bench_now_ns();
+    ForwardingTable *fib = forwarding_table_build(topo, dests, n_dests, 0);
+    double build_ms = (bench_now_ns() - t0) / 1e6;
+    if (!fib) {
+        fprintf(stderr, "Failed to build forwarding table!\n");
+    } else {
+        printf("Forwarding table: %u nodes x %u destinations (%.1f MiB) built in %.1f ms\n",
+               fib->n_nodes, fib->n_dests, (double)fib->n_nodes * fib->n_dests * sizeof(RouteEntry) / (1 << 20), build_ms);
+        run_multihop_simulation(100, 2000, 10, 50, topo, fib, 0);
+    }
+
+    forwarding_table_destroy(fib);
+    free(dests);
+    topology_destroy(topo);
+}
+
+/* rare: overflow probability of an M/M/1/K queue, RESTART vs brute force with the same number of events
+* defaults give about 1e-6 (lambda 0.5, mu 1, buffer 20), one threshold per packet and 2 splits per crossing
+*/
+void run_rare_event_demo(int argc, char *argv[]) {
+    SplitConfig cfg;
+    cfg.lambda = argc > 2 ? atof(argv[2]) : 0.5;
+    cfg.mu = argc > 3 ? atof(argv[3]) : 1.0;
+    cfg.buffer = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 10) : 20;
+    cfg.splits = argc > 5 ? (uint32_t)strtoul(argv[5], NULL, 10) : 2;
+    cfg.roots = argc > 6 ? strtoull(argv[6], NULL, 10) : 100000;
+    cfg.n_levels = 0;    // one threshold per occupancy value
+    cfg.max_events = 0;
+    cfg.seed = 0;
+
+    SplitResult restart, brute;
+    srand(time(NULL));
+    double t0 = bench_now_ns();
+    if (restart_estimate(&cfg, &restart) != 0) {
+        fprintf(stderr, "RESTART estimation failed (check the parameters)!\n");
+        return;
+    }
+    double restart_ms = (bench_now_ns() - t0) / 1e6;
+    restart_print_result("RESTART ESTIMATE", &cfg, &restart);
+    printf("  Wall time: %.1f ms\n", restart_ms);
+
+    SplitConfig brute_cfg = cfg;
+    brute_cfg.splits = 1;
+    brute_cfg.roots = UINT64_MAX;
+    brute_cfg.max_events = restart.events;
+    t0 = bench_now_ns();
+    if (restart_estimate(&brute_cfg, &brute) != 0) {
+        fprintf(stderr, "Brute force estimation failed!\n");
+        return;
+    }
+    double brute_ms = (bench_now_ns() - t0) / 1e6;
+    restart_print_result("BRUTE FORCE (same number of events)", &brute_cfg, &brute);
+    printf("  Wall time: %.1f ms\n", brute_ms);
+
+    // cycles brute force needs for RESTART's relative error: (1 - p) / (p * re^2), at its own events per cycle
+    if (restart.estimate > 0.0 && restart.relative_error > 0.0 && brute.roots > 0) {
+        double p = restart.estimate;
+        double cycles = (1.0 - p) / (p * restart.relative_error * restart.relative_error);
+        double events = cycles * ((double)brute.events / brute.roots);
+        printf("\n=== OVERALL ===\n");
+        printf("  Brute force would need ~%.3e events for the same relative error (%.0fx more work)\n",
+               events, events / restart.events);
+    }
+}
+
+/* ---- bench-proc: process (coroutine) style vs callback style ----
+* Both versions keep BENCH_ACTORS actors alive, each advancing by one time unit per step:
+* - callback: the task re-creates its own next event, like sender_task
+* - process: a loop around sim_wait(1)
+* The difference per event is the price of two coroutine switches. A ucontext round trip is timed for reference,
+* plus a sim_send/sim_recv ping-pong between two processes.
+*/
+#define BENCH_ACTORS 1000
+
+static EventScheduler *bench_scheduler = NULL;
+static ucontext_t bench_main_ctx, bench_uc_ctx;
+
+static void bench_callback_task(void *context) {
+    uint64_t *remaining = (uint64_t *)context;
+    if (--*remaining == 0)
+        return;
+    Event *next = event_create(current_sim_time + 1, EVENT_CUSTOM, bench_callback_task, remaining, NULL);
+    if (event_scheduler_push(bench_scheduler, next) != 0)
+        event_destroy(next);
+}
+
+static void bench_process_body(void *arg) {
+    uint64_t steps = *(uint64_t *)arg;
+    for (uint64_t i = 0; i < steps; i++)
+        sim_wait(1);
+}
+
+static void bench_pong_body(void *arg) {
+    (void)arg;
+    SimProcess *peer;
+    while ((peer = sim_recv()) != NULL)
+        sim_send(peer, 1, sim_self());
+}
+
+typedef struct {
+    SimProcess *pong;
+    uint64_t rounds;
+} BenchPing;
+
+static void bench_ping_body(void *arg) {
+    BenchPing *ping = (BenchPing *)arg;
+    for (uint64_t i = 0; i < ping->rounds; i++) {
+        sim_send(ping->pong, 1, sim_self());
+        sim_recv();
+    }
+    sim_send(ping->pong, 1, NULL);
+}
+
+static void bench_uc_body(void) {
+    for (;;)
+        swapcontext(&bench_uc_ctx, &bench_main_ctx);
+}
+
+void run_process_benchmark(uint64_t events) {
+    printf("\n=== Running Process vs Callback Benchmark ===\n");
+    uint64_t steps = events / BENCH_ACTORS;
+    if (steps == 0)
+        steps = 1;
+    events = steps * BENCH_ACTORS;
+
+    bench_scheduler = event_scheduler_create(BENCH_ACTORS * 2);
+    if (!bench_scheduler) {
+        fprintf(stderr, "Failed to create scheduler!\n");
+        return;
+    }
+
+    // callback style
+    uint64_t *remaining = malloc(sizeof(uint64_t) * BENCH_ACTORS);
+    if (!remaining) {
+        event_scheduler_destroy(bench_scheduler);
+        return;
+    }
+    for (int i = 0; i < BENCH_ACTORS; i++) {
+        remaining[i] = steps;
+        event_scheduler_push(bench_scheduler, event_create(0, EVENT_CUSTOM, bench_callback_task, &remaining[i], NULL));
+    }
+    double t0 = bench_now_ns();
+    event_loop_run(bench_scheduler);
+    double callback_ns = (bench_now_ns() - t0) / events;
+    free(remaining);
+
+    // process style (each wait is one event, plus the start event of every process)
+    for (int i = 0; i < BENCH_ACTORS; i++)
+        process_release(process_spawn(bench_scheduler, 0, bench_process_body, &steps));
+    t0 = bench_now_ns();
+    event_loop_run(bench_scheduler);
+    double process_ns = (bench_now_ns() - t0) / (events + BENCH_ACTORS);
+
+    // message passing ping-pong
+    BenchPing ping;
+    ping.pong = process_spawn(bench_scheduler, 0, bench_pong_body, NULL);
+    ping.rounds = events / 2;
+    process_release(process_spawn(bench_scheduler, 0, bench_ping_body, &ping));
+    t0 = bench_now_ns();
+    event_loop_run(bench_scheduler);
+    double pingpong_ns = (bench_now_ns() - t0) / events;
+    process_release(ping.pong);
+
+    process_shutdown();
+    event_scheduler_destroy(bench_scheduler);
+    bench_scheduler = NULL;
+
+    // ucontext round trip for reference
+    static char uc_stack[PROCESS_STACK_SIZE];
+    getcontext(&bench_uc_ctx);
+    bench_uc_ctx.uc_stack.ss_sp = uc_stack;
+    bench_uc_ctx.uc_stack.ss_size = sizeof(uc_stack);
+    bench_uc_ctx.uc_link = NULL;
+    makecontext(&bench_uc_ctx, bench_uc_body, 0);
+    t0 = bench_now_ns();
+    for (uint64_t i = 0; i < events; i++)
+        swapcontext(&bench_main_ctx, &bench_uc_ctx);
+    double ucontext_ns = (bench_now_ns() - t0) / events;
+
+    printf("  Actors: %d, events per style: %llu\n", BENCH_ACTORS, (unsigned long long)events);
+    printf("  Callback style:          %8.1f ns/event\n", callback_ns);
+    printf("  Process style:           %8.1f ns/event\n", process_ns);
+    printf("  Switch overhead:         %8.1f ns/event (resume + yield)\n", process_ns - callback_ns);
+    printf("  sim_send/sim_recv:       %8.1f ns/message\n", pingpong_ns);
+    printf("  ucontext round trip:     %8.1f ns (reference)\n", ucontext_ns);
+}
+
 void print_usage(const char *progname) {
     printf("Usage: %s [mode]\n", progname);
     printf("\nModes:\n");
@@ -52,6 +344,23 @@ void print_usage(const char *progname) {
     printf("  demo1     - Network simulation with fixed interval (100ms, 20 packets)\n");
     printf("  demo2     - Network simulation with exponential distribution\n");
     printf("  demo3     - Long running simulation (1000 packets)\n");
+    printf("  demo4 [delay_hist] [size_hist]\n");
+    printf("            - Network simulation with sampled delays and packet sizes\n");
+    printf("              (lognormal delay and 64/576/1500 byte mix unless histogram files are given)\n");
+    printf("  demo5 [nodes|topology_file] [destinations]\n");
+    printf("            - Multi-hop routing with precomputed forwarding tables\n");
+    printf("              (random graph of 100000 nodes and 16 destinations by default)\n");
+    printf("  rare [lambda mu buffer splits cycles]\n");
+    printf("            - RESTART estimate of a tiny overflow probability vs brute force\n");
+    printf("  realtime [ns_per_unit] [inject_interval_ns]\n");
+    printf("            - Demo1 paced against the wall clock (1 ms per unit) with a thread injecting packets\n");
+    printf("  embed     - Drive demo1 incrementally through the libsdes API\n");
+    printf("  bench-proc [events]\n");
+    printf("            - Benchmark process (coroutine) models against callback chains\n");
+    printf("  trace <trace.bin> [finish_time]\n");
+    printf("            - Replay a binary arrival trace (silent, statistics only)\n");
+    printf("  trace-convert <in.csv> <out.bin>\n");
+    printf("            - Convert 'timestamp,size' CSV lines into a binary trace\n");
     printf("  default   - Run demo1 (if no mode specified)\n");
     printf("\nExamples:\n");
     printf("  %s test\n", progname);
@@ -74,6 +383,58 @@ int main(int argc, char *argv[]) {
     if (strcmp(mode, "test") == 0) {
         run_simple_test();
     }
+    else if (strcmp(mode, "demo4") == 0) {
+        printf("\n=== DEMO 4: Empirical / Parametric Distribution Network Simulation ===\n");
+        printf("Sender: Every 100 time units\n");
+        printf("Finish: After 2000 time units (~20 packets)\n\n");
+
+        run_distribution_demo(argc > 2 ? argv[2] : NULL, argc > 3 ? argv[3] : NULL);
+    }
+    else if (strcmp(mode, "bench-proc") == 0) {
+        run_process_benchmark(argc > 2 ? strtoull(argv[2], NULL, 10) : 2000000);
+    }
+    else if (strcmp(mode, "demo5") == 0) {
+        printf("\n=== DEMO 5: Multi-hop Routing Network Simulation ===\n");
+        printf("Sender: Every 100 time units\n");
+        printf("Finish: After 2000 time units (~20 packets)\n");
+        printf("Access delay: 10-50 time units, link delay: 1-10 time units\n\n");
+
+        run_routing_demo(argc > 2 ? argv[2] : NULL, argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 0);
+    }
+    else if (strcmp(mode, "rare") == 0) {
+        run_rare_event_demo(argc, argv);
+    }
+    else if (strcmp(mode, "realtime") == 0) {
+        printf("\n=== REAL-TIME: Wall-clock Paced Network Simulation ===\n");
+        printf("Sender: Every 100 time units\n");
+        printf("Finish: After 2000 time units (~20 packets)\n");
+        printf("Network delay: 10-50 time units\n\n");
+
+        run_realtime_simulation(100, 2000, 10, 50,
+                                argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000,
+                                argc > 3 ? strtoull(argv[3], NULL, 10) : 150000000);
+    }
+    else if (strcmp(mode, "embed") == 0) {
+        run_embed_demo();
+    }
+    else if (strcmp(mode, "trace") == 0) {
+        if (argc < 3) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        network_sim_verbose = 0;    // billions of records: one line each would dominate the run
+        run_trace_simulation(argv[2], argc > 3 ? strtoull(argv[3], NULL, 10) : 0, 10, 50);
+    }
+    else if (strcmp(mode, "trace-convert") == 0) {
+        if (argc < 4) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        int64_t count = trace_convert_csv(argv[2], argv[3]);
+        if (count < 0)
+            return 1;
+        printf("Wrote %lld records to %s\n", (long long)count, argv[3]);
+    }
     else if (strcmp(mode, "demo1") == 0) {
         printf("\n=== DEMO 1: Fixed Interval Network Simulation ===\n");
         printf("Sender: Every 100 time units\n");
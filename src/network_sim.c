@@ -1,14 +1,22 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "network_sim.h"
 #include "event.h"
 #include "event_scheduler.h"
 #include "event_loop.h"
 #include "packet.h"
+#include "trace.h"
+#include "distribution.h"
+#include "routing.h"
+#include "realtime.h"
 
 EventScheduler *global_scheduler = NULL;
+int network_sim_verbose = 1;
 
 static double random_double(void) {    // 这是个轮子, used to generate a random double between 0 and 1
     return (double)rand() / RAND_MAX;
@@ -38,6 +46,8 @@ SenderContext *sender_create(uint64_t interval, uint64_t finish_time, SenderMode
     sender->network = NULL;
     sender->packet_size = packet_size;
     sender->total_bytes_sent = 0;
+    sender->trace = NULL;
+    sender->size_dist = NULL;
     return sender;
 }
 
@@ -47,6 +57,54 @@ void sender_destroy(SenderContext *sender) {
         free(sender);
 }
 
+void sender_set_trace(SenderContext *sender, TraceFile *trace) {
+    if (!sender)
+        return;
+    sender->mode = SENDER_TRACE;
+    sender->trace = trace;
+}
+
+void sender_set_size_distribution(SenderContext *sender, Distribution *size_dist) {
+    if (sender)
+        sender->size_dist = size_dist;
+}
+
+// a sample rounded to an integer in [min, DIST_SAMPLE_MAX]; clamped first, llround of a larger double is undefined
+static uint64_t sample_clamped(const Distribution *dist, uint64_t min) {
+    double x = distribution_sample(dist);
+    if (!(x >= (double)min))
+        return min;
+    return x >= DIST_SAMPLE_MAX ? (uint64_t)DIST_SAMPLE_MAX : (uint64_t)llround(x);
+}
+
+// rounded to whole bytes, at least one
+static uint64_t sample_size(const Distribution *dist) {
+    return sample_clamped(dist, 1);
+}
+
+// current_sim_time + delay, saturating instead of wrapping to an event in the past
+static uint64_t time_after(uint64_t delay) {
+    return delay > UINT64_MAX - current_sim_time ? UINT64_MAX : current_sim_time + delay;
+}
+
+// the fixed/exponential senders start at 0, the trace sender at its first record
+uint64_t sender_first_send_time(SenderContext *sender) {
+    if (sender && sender->mode == SENDER_TRACE) {
+        const TraceRecord *rec = trace_peek(sender->trace);
+        return rec ? rec->time : 0;
+    }
+    return 0;
+}
+
+static const char *sender_mode_name(SenderMode mode) {
+    switch (mode) {
+    case SENDER_FIXED_INTERVAL: return "Fixed interval";
+    case SENDER_EXPONENTIAL: return "Exponential";
+    case SENDER_TRACE: return "Trace replay";
+    }
+    return "Unknown";
+}
+
 /* this is kind of complex...
 * the sender_task is responsible for sending packets at specified intervals or based on an exponential distribution.
 * 1. Check if the current simulation time has reached the finish time. If so, it stops sending packets.
@@ -56,23 +114,37 @@ void sender_destroy(SenderContext *sender) {
 *    - For fixed mode, uses interval.
 *    - For exponential mode, uses random_exponential to get the next interval (>=1).
 * 5. If the next sending time is before the finish time, it schedules the next sender_task event. This creates a loop where the sender continues to send packets until the finish time is reached.
+* In trace mode the packet size comes from the record under the trace cursor and the next sending time is the
+* timestamp of the following record, so only one sender event is ever pending while the trace streams from the mmap.
 */
 void sender_task(void *context) {
     SenderContext *sender = (SenderContext *)context;
     if (current_sim_time >= sender->finish_time) {
-        printf("[Sender] Stopped at time %llu\n", (unsigned long long)current_sim_time);
+        if (network_sim_verbose)
+            printf("[Sender] Stopped at time %llu\n", (unsigned long long)current_sim_time);
         return;
     }
 
+    uint64_t size = sender->packet_size;
+    if (sender->mode == SENDER_TRACE) {
+        const TraceRecord *rec = trace_next(sender->trace);
+        if (!rec)
+            return;
+        size = rec->size;
+    } else if (sender->size_dist) {
+        size = sample_size(sender->size_dist);
+    }
+
     // create a packet object
-    Packet *pkt = packet_create(sender->packets_sent + 1, current_sim_time, sender->packet_size);
+    Packet *pkt = packet_create(sender->packets_sent + 1, current_sim_time, size);
     if (!pkt) {
         fprintf(stderr, "[Sender] Packet allocation failed\n");
         return;
     }
 
-    printf("[Sender] Sent packet #%d at time %llu size=%llu bytes\n",
-           sender->packets_sent + 1, (unsigned long long)current_sim_time, (unsigned long long)packet_get_size(pkt));
+    if (network_sim_verbose)
+        printf("[Sender] Sent packet #%llu at time %llu size=%llu bytes\n",
+               (unsigned long long)(sender->packets_sent + 1), (unsigned long long)current_sim_time, (unsigned long long)packet_get_size(pkt));
     sender->packets_sent++;
     sender->total_bytes_sent += packet_get_size(pkt);
 
@@ -85,16 +157,24 @@ void sender_task(void *context) {
         return;
     }
 
-    uint64_t next_interval;
-    if (sender->mode == SENDER_FIXED_INTERVAL) {
-        next_interval = sender->interval;
+    uint64_t next_time;
+    if (sender->mode == SENDER_TRACE) {
+        const TraceRecord *next = trace_peek(sender->trace);
+        if (!next)
+            return;
+        next_time = next->time > current_sim_time ? next->time : current_sim_time;
     } else {
-        next_interval = random_exponential(sender->lambda);
-        if (next_interval < 1)
-            next_interval = 1;
+        uint64_t next_interval;
+        if (sender->mode == SENDER_FIXED_INTERVAL) {
+            next_interval = sender->interval;
+        } else {
+            next_interval = random_exponential(sender->lambda);
+            if (next_interval < 1)
+                next_interval = 1;
+        }
+        next_time = current_sim_time + next_interval;
     }
 
-    uint64_t next_time = current_sim_time + next_interval;
     if (next_time < sender->finish_time) {
         Event *next_send = event_create(next_time, EVENT_SEND_PACKET, sender_task, sender, NULL);
         if (event_scheduler_push(global_scheduler, next_send) != 0) {
@@ -107,15 +187,24 @@ void sender_task(void *context) {
 // ez print
 void sender_print_stats(SenderContext *sender) {
     printf("\n=== SENDER STATISTICS ===\n");
-    printf("  Packets sent: %d\n", sender->packets_sent);
+    printf("  Packets sent: %llu\n", (unsigned long long)sender->packets_sent);
     printf("  Total bytes sent: %llu\n", (unsigned long long)sender->total_bytes_sent);
-    printf("  Mode: %s\n", sender->mode == SENDER_FIXED_INTERVAL ? "Fixed interval" : "Exponential");
+    printf("  Mode: %s\n", sender_mode_name(sender->mode));
     if (sender->mode == SENDER_FIXED_INTERVAL) {
         printf("  Interval: %llu\n", (unsigned long long)sender->interval);
-    } else {
+    } else if (sender->mode == SENDER_EXPONENTIAL) {
         printf("  Lambda: %.6f\n", sender->lambda);
+    } else {
+        printf("  Trace records replayed: %llu / %llu\n",
+               (unsigned long long)(sender->trace ? sender->trace->cursor : 0),
+               (unsigned long long)(sender->trace ? sender->trace->count : 0));
     }
-    printf("  Packet size: %llu\n", (unsigned long long)sender->packet_size);
+    if (sender->mode == SENDER_TRACE)
+        return;
+    if (sender->size_dist)
+        printf("  Packet size: %s\n", sender->size_dist->name);
+    else
+        printf("  Packet size: %llu\n", (unsigned long long)sender->packet_size);
 }
 
 NetworkContext *network_create(uint64_t min_delay, uint64_t max_delay) {
@@ -127,6 +216,8 @@ NetworkContext *network_create(uint64_t min_delay, uint64_t max_delay) {
     network->max_delay = max_delay;
     network->receiver = NULL;
     network->total_bytes_forwarded = 0;
+    network->delay_dist = NULL;
+    network->multihop = NULL;
     return network;
 }
 
@@ -135,28 +226,50 @@ void network_destroy(NetworkContext *network) {
         free(network);
 }
 
+void network_set_delay_distribution(NetworkContext *network, Distribution *delay_dist) {
+    if (network)
+        network->delay_dist = delay_dist;
+}
+
 /* So, the second task...
 * 1. Prints the timestamp when a packet is received.
 * 2. Increments the packets_forwarded count.
-* 3. Generates a random delay within the specified min and max range.
+* 3. Generates a random delay within the specified min and max range
+*    (or draws it from delay_dist if set, clamped to DIST_SAMPLE_MAX).
 * 4. Schedules a receiver event during (current_sim_time + delay) to simulate delayed packet arrival at the receiver.
+*    With a multi-hop network attached, the packet gets a random destination and enters it at the ingress node instead.
 */
 void network_task(void *context) {
     NetworkContext *network = (NetworkContext *)context;
     Packet *pkt = current_event ? current_event->packet : NULL;
-    printf("[Network] Received packet at time %llu\n", (unsigned long long)current_sim_time);
+    if (network_sim_verbose)
+        printf("[Network] Received packet at time %llu\n", (unsigned long long)current_sim_time);
 
     if (pkt) {
         network->packets_forwarded++;
         network->total_bytes_forwarded += packet_get_size(pkt);
     }
 
-    uint64_t delay = random_delay(network->min_delay, network->max_delay);
-    printf("[Network] Forwarding with delay %llu\n", (unsigned long long)delay);
-
-    // Forward to receiver keeping same packet pointer
-    Event *receiver_event = event_create(current_sim_time + delay, EVENT_PACKET_RECEIVED,
-                                        receiver_task, network->receiver, pkt);
+    uint64_t delay;
+    if (network->delay_dist) {
+        delay = sample_clamped(network->delay_dist, 0);
+    } else {
+        delay = random_delay(network->min_delay, network->max_delay);
+    }
+    if (network_sim_verbose)
+        printf("[Network] Forwarding with delay %llu\n", (unsigned long long)delay);
+
+    // Forward to receiver (or into the multi-hop network) keeping same packet pointer
+    EventTask next_task = receiver_task;
+    void *next_context = network->receiver;
+    if (network->multihop && pkt) {
+        MultiHopContext *multihop = network->multihop;
+        packet_set_route(pkt, multihop->ingress, (uint32_t)(rand() % multihop->fib->n_dests));
+        next_task = multihop_task;
+        next_context = multihop;
+    }
+    Event *receiver_event = event_create(time_after(delay), EVENT_PACKET_RECEIVED,
+                                        next_task, next_context, pkt);
     if (event_scheduler_push(global_scheduler, receiver_event) != 0) {
         fprintf(stderr, "[Network] Failed to schedule receiver event!\n");
         // drop packet (this is very 细节)
@@ -167,10 +280,100 @@ void network_task(void *context) {
 
 void network_print_stats(NetworkContext *network) {
     printf("\n=== NETWORK STATISTICS ===\n");
-    printf("  Packets forwarded: %d\n", network->packets_forwarded);
+    printf("  Packets forwarded: %llu\n", (unsigned long long)network->packets_forwarded);
     printf("  Total bytes forwarded: %llu\n", (unsigned long long)network->total_bytes_forwarded);
-    printf("  Delay range: %llu - %llu\n",
-           (unsigned long long)network->min_delay, (unsigned long long)network->max_delay);
+    if (network->delay_dist)
+        printf("  Delay distribution: %s\n", network->delay_dist->name);
+    else
+        printf("  Delay range: %llu - %llu\n",
+               (unsigned long long)network->min_delay, (unsigned long long)network->max_delay);
+}
+
+MultiHopContext *multihop_create(const Topology *topology, const ForwardingTable *fib, uint32_t ingress) {
+    if (!topology || !fib || ingress >= topology->n_nodes)
+        return NULL;
+    MultiHopContext *multihop = malloc(sizeof(MultiHopContext));
+    if (!multihop)
+        return NULL;
+    multihop->topology = topology;
+    multihop->fib = fib;
+    multihop->ingress = ingress;
+    multihop->receiver = NULL;
+    multihop->packets_routed = 0;
+    multihop->packets_delivered = 0;
+    multihop->packets_dropped = 0;
+    multihop->total_hops = 0;
+    return multihop;
+}
+
+void multihop_destroy(MultiHopContext *multihop) {
+    if (multihop)
+        free(multihop);
+}
+
+/* the multi-hop task, run once per hop...
+* 1. If the packet's current node is its destination, hands it to the receiver right away.
+* 2. Otherwise looks up the next node and link delay in the forwarding table (one 8-byte entry) and, if there is
+*    none, drops the packet (destination unreachable).
+* 3. Moves the packet to that node and reschedules itself after the link delay.
+*/
+void multihop_task(void *context) {
+    MultiHopContext *multihop = (MultiHopContext *)context;
+    Packet *pkt = current_event ? current_event->packet : NULL;
+    if (!pkt)
+        return;
+
+    const ForwardingTable *fib = multihop->fib;
+    if (pkt->hops == 0)
+        multihop->packets_routed++;
+
+    if (pkt->node == fib->dests[pkt->dest_slot]) {
+        multihop->packets_delivered++;
+        multihop->total_hops += pkt->hops;
+        if (network_sim_verbose)
+            printf("[MultiHop] Packet #%llu reached node %u after %u hops at time %llu\n",
+                   (unsigned long long)packet_get_id(pkt), pkt->node, pkt->hops, (unsigned long long)current_sim_time);
+        Event *receiver_event = event_create(current_sim_time, EVENT_PACKET_RECEIVED,
+                                            receiver_task, multihop->receiver, pkt);
+        if (event_scheduler_push(global_scheduler, receiver_event) != 0) {
+            fprintf(stderr, "[MultiHop] Failed to schedule receiver event!\n");
+            packet_destroy(pkt);
+            event_destroy(receiver_event);
+        }
+        return;
+    }
+
+    RouteEntry hop = forwarding_next_hop(fib, pkt->node, pkt->dest_slot);
+    if (hop.next == ROUTE_NONE) {
+        multihop->packets_dropped++;
+        if (network_sim_verbose)
+            printf("[MultiHop] Dropped packet #%llu at node %u: no route\n", (unsigned long long)packet_get_id(pkt), pkt->node);
+        packet_destroy(pkt);
+        current_event->packet = NULL;
+        return;
+    }
+
+    pkt->node = hop.next;
+    pkt->hops++;
+    Event *hop_event = event_create(time_after(hop.delay), EVENT_PACKET_RECEIVED,
+                                    multihop_task, multihop, pkt);
+    if (event_scheduler_push(global_scheduler, hop_event) != 0) {
+        fprintf(stderr, "[MultiHop] Failed to schedule next hop!\n");
+        multihop->packets_dropped++;
+        packet_destroy(pkt);
+        event_destroy(hop_event);
+    }
+}
+
+void multihop_print_stats(MultiHopContext *multihop) {
+    printf("\n=== MULTI-HOP NETWORK STATISTICS ===\n");
+    printf("  Nodes: %u, links: %u, destinations: %u\n",
+           multihop->topology->n_nodes, multihop->topology->n_edges, multihop->fib->n_dests);
+    printf("  Packets routed: %llu\n", (unsigned long long)multihop->packets_routed);
+    printf("  Packets delivered: %llu\n", (unsigned long long)multihop->packets_delivered);
+    printf("  Packets dropped (no route): %llu\n", (unsigned long long)multihop->packets_dropped);
+    if (multihop->packets_delivered > 0)
+        printf("  Average hops: %.2f\n", (double)multihop->total_hops / multihop->packets_delivered);
 }
 
 ReceiverContext *receiver_create(void) {
@@ -212,20 +415,24 @@ void receiver_task(void *context) {
 
     if (!receiver->first_packet) {
         receiver->time_between_packets = current_sim_time - receiver->last_receive_time;
-        printf("[Receiver] Received packet #%d at time %llu (gap: %llu)",
-               receiver->packets_received, (unsigned long long)current_sim_time,
-               (unsigned long long)receiver->time_between_packets);
-        if (pkt) {
-            printf(" latency=%llu size=%llu\n", (unsigned long long)receiver->last_latency, (unsigned long long)packet_get_size(pkt));
-        } else {
-            printf(" (no packet object)\n");
+        if (network_sim_verbose) {
+            printf("[Receiver] Received packet #%llu at time %llu (gap: %llu)",
+                   (unsigned long long)receiver->packets_received, (unsigned long long)current_sim_time,
+                   (unsigned long long)receiver->time_between_packets);
+            if (pkt) {
+                printf(" latency=%llu size=%llu\n", (unsigned long long)receiver->last_latency, (unsigned long long)packet_get_size(pkt));
+            } else {
+                printf(" (no packet object)\n");
+            }
         }
     } else {
-        printf("[Receiver] Received first packet at time %llu", (unsigned long long)current_sim_time);
-        if (pkt) {
-            printf(" latency=%llu size=%llu\n", (unsigned long long)receiver->last_latency, (unsigned long long)packet_get_size(pkt));
-        } else {
-            printf(" (no packet object)\n");
+        if (network_sim_verbose) {
+            printf("[Receiver] Received first packet at time %llu", (unsigned long long)current_sim_time);
+            if (pkt) {
+                printf(" latency=%llu size=%llu\n", (unsigned long long)receiver->last_latency, (unsigned long long)packet_get_size(pkt));
+            } else {
+                printf(" (no packet object)\n");
+            }
         }
         receiver->first_packet = 0;
     }
@@ -240,7 +447,7 @@ void receiver_task(void *context) {
 
 void receiver_print_stats(ReceiverContext *receiver) {
     printf("\n=== RECEIVER STATISTICS ===\n");
-    printf("  Packets received: %d\n", receiver->packets_received);
+    printf("  Packets received: %llu\n", (unsigned long long)receiver->packets_received);
     if (receiver->packets_received > 0) {
         printf("  Last receive time: %llu\n", (unsigned long long)receiver->last_receive_time);
         printf("  Total bytes received: %llu\n", (unsigned long long)receiver->total_bytes_received);
@@ -253,57 +460,211 @@ void receiver_print_stats(ReceiverContext *receiver) {
     }
 }
 
+/* what one run_*_simulation call sets up: the demo1 chain plus the optional hooks of the other modes */
+typedef struct SimulationSetup {
+    const char *title;    // banner line
+    size_t capacity;    // scheduler capacity
+
+    // the sender -> network -> receiver chain, as in run_network_simulation
+    SenderMode mode;
+    uint64_t sender_interval;
+    uint64_t finish_time;    // with a trace: 0 = the whole trace
+    double lambda;
+    uint64_t net_min_delay;
+    uint64_t net_max_delay;
+    uint64_t packet_size;
+
+    // hooks, left NULL / 0 when unused
+    const char *trace_path;    // SENDER_TRACE: arrivals and sizes from this binary trace
+    Distribution *delay_dist;    // network delays drawn from here (borrowed)
+    Distribution *size_dist;    // packet sizes drawn from here (borrowed)
+    const Topology *topology;    // multi-hop network behind the access link, with fib and ingress
+    const ForwardingTable *fib;
+    uint32_t ingress;
+    uint64_t ns_per_tick;    // pace the run against the wall clock (realtime.h)
+    uint64_t inject_interval_ns;    // paced runs: a second thread injects external packets this often
+} SimulationSetup;
+
+static void simulation_setup_init(SimulationSetup *setup, const char *title) {
+    memset(setup, 0, sizeof(*setup));
+    setup->title = title;
+    setup->capacity = 10000;
+    setup->mode = SENDER_FIXED_INTERVAL;
+    setup->net_min_delay = 10;
+    setup->net_max_delay = 50;
+    setup->packet_size = 512;
+}
+
+static void print_simulation_config(const SimulationSetup *setup, const TraceFile *trace) {
+    printf("\n========================================\n");
+    printf("  %s\n", setup->title);
+    printf("========================================\n");
+    printf("Config:\n");
+    if (trace)
+        printf("  Trace: %s (%llu records)\n", setup->trace_path, (unsigned long long)trace->count);
+    else
+        printf("  Sender interval: %llu\n", (unsigned long long)setup->sender_interval);
+    if (trace && !setup->finish_time)
+        printf("  Finish time: end of trace\n");
+    else
+        printf("  Finish time: %llu\n", (unsigned long long)setup->finish_time);
+
+    const char *delay_label = setup->topology ? "Access delay" : "Network delay";
+    if (setup->delay_dist)
+        printf("  %s: %s\n", delay_label, setup->delay_dist->name);
+    else
+        printf("  %s: %llu - %llu\n", delay_label,
+               (unsigned long long)setup->net_min_delay, (unsigned long long)setup->net_max_delay);
+    if (setup->size_dist)
+        printf("  Packet size: %s\n", setup->size_dist->name);
+    if (!trace)
+        printf("  Mode: %s\n", setup->mode == SENDER_FIXED_INTERVAL ? "Fixed" : "Exponential");
+
+    if (setup->topology)
+        printf("  Topology: %u nodes, %u links, ingress node %u, %u destinations\n",
+               setup->topology->n_nodes, setup->topology->n_edges, setup->ingress, setup->fib->n_dests);
+    if (setup->ns_per_tick) {
+        printf("  Pace: %llu ns per time unit\n", (unsigned long long)setup->ns_per_tick);
+        if (setup->inject_interval_ns)
+            printf("  External packets every %llu ns\n", (unsigned long long)setup->inject_interval_ns);
+    }
+    printf("========================================\n\n");
+}
+
+// the external traffic source of paced runs, running on its own thread
+typedef struct {
+    RealtimeLoop *rt;
+    NetworkContext *network;
+    uint64_t interval_ns;
+    uint64_t finish_time;
+    atomic_int done;
+    uint64_t injected;
+} ExternalSource;
+
+static void *external_source_thread(void *arg) {
+    ExternalSource *source = (ExternalSource *)arg;
+    struct timespec pause;
+    pause.tv_sec = (time_t)(source->interval_ns / 1000000000ull);
+    pause.tv_nsec = (long)(source->interval_ns % 1000000000ull);
+
+    while (!atomic_load(&source->done)) {
+        nanosleep(&pause, NULL);
+        uint64_t now = realtime_now(source->rt);
+        if (now == 0)
+            continue;    // the loop has not started yet
+        if (now >= source->finish_time)
+            break;
+
+        Packet *pkt = packet_create(100000 + source->injected, now, 1500);
+        Event *ev = event_create(now, EVENT_PACKET_RECEIVED, network_task, source->network, pkt);
+        if (!pkt || !ev || realtime_inject(source->rt, ev) != 0) {
+            packet_destroy(pkt);
+            event_destroy(ev);
+            continue;
+        }
+        source->injected++;
+    }
+    return NULL;
+}
+
+/* the pacing hook...
+* 1. Starts the external source thread (if inject_interval_ns is set); it injects 1500-byte packets into the
+*    network stage through the lock-free queue, stamped with realtime_now().
+* 2. Runs realtime_run until the simulation clock passes finish_time + net_max_delay.
+* 3. Stops and joins the source; events it still had in flight are left for the cleanup.
+* Returns the number of packets the source injected.
+*/
+static uint64_t run_paced(const SimulationSetup *setup, RealtimeLoop *rt, NetworkContext *network) {
+    ExternalSource source;
+    source.rt = rt;
+    source.network = network;
+    source.interval_ns = setup->inject_interval_ns;
+    source.finish_time = setup->finish_time;
+    source.injected = 0;
+    atomic_init(&source.done, 0);
+
+    pthread_t source_thread;
+    int source_started = setup->inject_interval_ns > 0 &&
+                         pthread_create(&source_thread, NULL, external_source_thread, &source) == 0;
+
+    realtime_run(rt, global_scheduler, setup->finish_time + setup->net_max_delay);
+
+    if (source_started) {
+        atomic_store(&source.done, 1);
+        pthread_join(source_thread, NULL);
+    }
+    return source.injected;
+}
+
 /* now is the time to run the whole simulation...
 * 1. Initializes the random number generator and creates the global event scheduler.
-* 2. Creates the global scheduler, and receiver/network/sender.
-* 3. Links the components together (network to receiver, sender to network).
-* 4. Prints the simulation configuration.
-* 5. Schedules the initial sender event to kick off the simulation.
-* 6. Runs the event loop until all events are processed.
-* 7. After completion, prints final statistics for each component and overall packet loss/delivery rates.
-* 8. Cleans up all allocated resources (contexts and scheduler).
+* 2. Creates receiver/network/sender and links them together (network to receiver, sender to network),
+*    then attaches the hooks the setup asks for: trace, distributions, multi-hop network, pacing.
+* 3. Prints the simulation configuration.
+* 4. Schedules the initial sender event and runs the event loop (paced, if asked) until all events are processed.
+* 5. After completion, prints final statistics for each component and overall packet loss/delivery rates.
+* 6. Cleans up all allocated resources (pending events, contexts and scheduler).
 */
-void run_network_simulation(uint64_t sender_interval, uint64_t finish_time, SenderMode mode,
-                           double lambda, uint64_t net_min_delay, uint64_t net_max_delay, uint64_t packet_size) {
+static void run_simulation(const SimulationSetup *setup) {
     srand(time(NULL));
 
-    global_scheduler = event_scheduler_create(10000);
+    SenderContext *sender = NULL;
+    NetworkContext *network = NULL;
+    ReceiverContext *receiver = NULL;
+    MultiHopContext *multihop = NULL;
+    TraceFile *trace = NULL;
+    RealtimeLoop *rt = NULL;
+
+    if (setup->trace_path && !(trace = trace_open(setup->trace_path)))
+        return;
+
+    global_scheduler = event_scheduler_create(setup->capacity);
     if (!global_scheduler) {
         fprintf(stderr, "Failed to create scheduler!\n");
-        return;
+        goto cleanup;
     }
 
-    ReceiverContext *receiver = receiver_create();
-    NetworkContext *network = network_create(net_min_delay, net_max_delay);
-    SenderContext *sender = sender_create(sender_interval, finish_time, mode, lambda, packet_size);
-
-    if (!receiver || !network || !sender) {
+    uint64_t finish_time = setup->finish_time;
+    if (trace && finish_time == 0)
+        finish_time = UINT64_MAX;
+    receiver = receiver_create();
+    network = network_create(setup->net_min_delay, setup->net_max_delay);
+    sender = sender_create(setup->sender_interval, finish_time, setup->mode, setup->lambda, setup->packet_size);
+    if (setup->topology)
+        multihop = multihop_create(setup->topology, setup->fib, setup->ingress);
+    if (setup->ns_per_tick)
+        rt = realtime_create(setup->ns_per_tick);
+
+    if (!receiver || !network || !sender || (setup->topology && !multihop) || (setup->ns_per_tick && !rt)) {
         fprintf(stderr, "Failed to create components!\n");
         goto cleanup;
     }
 
     network->receiver = receiver;
     sender->network = network;
+    if (trace)
+        sender_set_trace(sender, trace);
+    network_set_delay_distribution(network, setup->delay_dist);
+    sender_set_size_distribution(sender, setup->size_dist);
+    if (multihop) {
+        multihop->receiver = receiver;
+        network->multihop = multihop;
+    }
 
-    printf("\n========================================\n");
-    printf("  NETWORK SIMULATION STARTING\n");
-    printf("========================================\n");
-    printf("Config:\n");
-    printf("  Sender interval: %llu\n", (unsigned long long)sender_interval);
-    printf("  Finish time: %llu\n", (unsigned long long)finish_time);
-    printf("  Network delay: %llu - %llu\n",
-           (unsigned long long)net_min_delay, (unsigned long long)net_max_delay);
-    printf("  Mode: %s\n", mode == SENDER_FIXED_INTERVAL ? "Fixed" : "Exponential");
-    printf("========================================\n\n");
+    print_simulation_config(setup, trace);
 
-    Event *initial_send = event_create(0, EVENT_SEND_PACKET, sender_task, sender, NULL);
+    Event *initial_send = event_create(sender_first_send_time(sender), EVENT_SEND_PACKET, sender_task, sender, NULL);
     if (event_scheduler_push(global_scheduler, initial_send) != 0) {
         fprintf(stderr, "Failed to schedule initial event!\n");
         event_destroy(initial_send);
         goto cleanup;
     }
 
-    event_loop_run(global_scheduler);
+    uint64_t injected = 0;    // packets entering the network beside the sender's
+    if (rt)
+        injected = run_paced(setup, rt, network);
+    else
+        event_loop_run(global_scheduler);
 
     printf("\n========================================\n");
     printf("  SIMULATION COMPLETED\n");
@@ -312,19 +673,111 @@ void run_network_simulation(uint64_t sender_interval, uint64_t finish_time, Send
 
     sender_print_stats(sender);
     network_print_stats(network);
+    if (multihop)
+        multihop_print_stats(multihop);
     receiver_print_stats(receiver);
+    if (rt) {
+        realtime_print_stats(rt);
+        printf("  External packets injected: %llu\n", (unsigned long long)injected);
+    }
 
     printf("\n=== OVERALL STATISTICS ===\n");
-    if (sender->packets_sent > 0) {
-        double loss_rate = 100.0 * (sender->packets_sent - receiver->packets_received) / sender->packets_sent;
+    uint64_t offered = sender->packets_sent + injected;
+    if (offered > 0) {
+        double loss_rate = 100.0 * ((double)offered - (double)receiver->packets_received) / (double)offered;
         printf("  Packet loss rate: %.2f%%\n", loss_rate);
         printf("  Delivery rate: %.2f%%\n", 100.0 - loss_rate);
     }
     printf("\n========================================\n\n");
 
 cleanup:
+    event_scheduler_clear(global_scheduler);    // a paced run stops with events still queued
     if (sender) sender_destroy(sender);
     if (network) network_destroy(network);
+    if (multihop) multihop_destroy(multihop);
     if (receiver) receiver_destroy(receiver);
     if (global_scheduler) event_scheduler_destroy(global_scheduler);
+    realtime_destroy(rt);
+    trace_close(trace);
+}
+
+void run_network_simulation(uint64_t sender_interval, uint64_t finish_time, SenderMode mode,
+                           double lambda, uint64_t net_min_delay, uint64_t net_max_delay, uint64_t packet_size) {
+    SimulationSetup setup;
+    simulation_setup_init(&setup, "NETWORK SIMULATION STARTING");
+    setup.mode = mode;
+    setup.sender_interval = sender_interval;
+    setup.finish_time = finish_time;
+    setup.lambda = lambda;
+    setup.net_min_delay = net_min_delay;
+    setup.net_max_delay = net_max_delay;
+    setup.packet_size = packet_size;
+    run_simulation(&setup);
+}
+
+/* the trace-driven variant...
+* The sender is switched to SENDER_TRACE and reads the mmapped trace front to back. The scheduler only ever holds
+* one pending sender event plus the packets in flight in the network, so it is sized for in-flight packets,
+* not for the length of the trace.
+*/
+void run_trace_simulation(const char *trace_path, uint64_t finish_time, uint64_t net_min_delay, uint64_t net_max_delay) {
+    SimulationSetup setup;
+    simulation_setup_init(&setup, "TRACE REPLAY STARTING");
+    setup.capacity = 1 << 20;
+    setup.mode = SENDER_TRACE;
+    setup.finish_time = finish_time;
+    setup.net_min_delay = net_min_delay;
+    setup.net_max_delay = net_max_delay;
+    setup.packet_size = 0;
+    setup.trace_path = trace_path;
+    run_simulation(&setup);
+}
+
+/* the distribution-driven variant...
+* Every packet size is drawn from size_dist and every network delay from delay_dist (either may be NULL to keep
+* 512 bytes / 10-50). The distributions are borrowed: the caller creates and destroys them.
+*/
+void run_distribution_simulation(uint64_t sender_interval, uint64_t finish_time, Distribution *delay_dist, Distribution *size_dist) {
+    SimulationSetup setup;
+    simulation_setup_init(&setup, "NETWORK SIMULATION STARTING");
+    setup.sender_interval = sender_interval;
+    setup.finish_time = finish_time;
+    setup.delay_dist = delay_dist;
+    setup.size_dist = size_dist;
+    run_simulation(&setup);
+}
+
+/* the multi-hop variant...
+* The network stage is only the access link: after its delay every packet enters the multi-hop network at the
+* ingress node with a random destination of fib, and reaches the receiver once it has been forwarded all the way there.
+*/
+void run_multihop_simulation(uint64_t sender_interval, uint64_t finish_time, uint64_t net_min_delay, uint64_t net_max_delay,
+                             const Topology *topology, const ForwardingTable *fib, uint32_t ingress) {
+    SimulationSetup setup;
+    simulation_setup_init(&setup, "MULTI-HOP SIMULATION STARTING");
+    setup.sender_interval = sender_interval;
+    setup.finish_time = finish_time;
+    setup.net_min_delay = net_min_delay;
+    setup.net_max_delay = net_max_delay;
+    setup.topology = topology;
+    setup.fib = fib;
+    setup.ingress = ingress;
+    run_simulation(&setup);
+}
+
+/* the real-time variant...
+* Every event waits for its wall-clock deadline (realtime_run), while a second thread plays the external world
+* and injects packets into the network stage. Deadline misses and jitter are printed with the usual statistics.
+*/
+void run_realtime_simulation(uint64_t sender_interval, uint64_t finish_time, uint64_t net_min_delay, uint64_t net_max_delay,
+                             uint64_t ns_per_tick, uint64_t inject_interval_ns) {
+    SimulationSetup setup;
+    simulation_setup_init(&setup, "REAL-TIME SIMULATION STARTING");
+    setup.sender_interval = sender_interval;
+    setup.finish_time = finish_time;
+    setup.net_min_delay = net_min_delay;
+    setup.net_max_delay = net_max_delay;
+    setup.ns_per_tick = ns_per_tick ? ns_per_tick : 1;
+    setup.inject_interval_ns = inject_interval_ns;
+    run_simulation(&setup);
 }
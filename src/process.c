@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "process.h"
+#include "event.h"
+#include "event_loop.h"
+#include "sysutil.h"
+
+#if defined(__x86_64__) && defined(__ELF__)
+#define PROCESS_ASM_SWITCH 1
+#else
+#include <ucontext.h>
+#endif
+
+typedef struct SimMessage {
+    void *payload;
+    struct SimProcess *dst;
+    struct SimMessage *next;
+} SimMessage;
+
+struct SimProcess {
+#ifdef PROCESS_ASM_SWITCH
+    void *sp;    // saved stack pointer while suspended
+#else
+    ucontext_t ctx;
+#endif
+    char *stack;    // base of the mapping (guard page first)
+    ProcessBody body;
+    void *arg;
+    EventScheduler *scheduler;
+    SimMessage *mailbox_head;
+    SimMessage *mailbox_tail;
+    int waiting_recv;    // suspended in sim_recv
+    int finished;    // body returned, stack already back in the pool
+    int released;    // the spawner gave up its handle (process_release)
+    uint64_t messages_in_flight;    // sim_send deliveries still queued, they point at this record
+    struct SimProcess *prev;    // list of every live record, for process_shutdown
+    struct SimProcess *next;
+};
+
+static SimProcess *current_process = NULL;    // process running right now, NULL on the event loop stack
+static SimProcess *all_processes = NULL;
+
+// the pool: stacks of finished processes, ready for the next spawn
+static char **free_stacks = NULL;
+static size_t free_count = 0;
+static size_t free_capacity = 0;
+
+#ifdef PROCESS_ASM_SWITCH
+static void *loop_sp = NULL;    // event loop stack pointer while a process runs
+
+/* sdes_process_switch(save, next):
+* pushes the callee-saved registers of the SysV ABI, stores the stack pointer in *save,
+* loads next and pops the registers of whoever saved it there, then returns into that context.
+*/
+void sdes_process_switch(void **save_sp, void *next_sp);
+__asm__(
+    ".text\n"
+    ".globl sdes_process_switch\n"
+    ".hidden sdes_process_switch\n"
+    ".type sdes_process_switch,@function\n"
+    "sdes_process_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size sdes_process_switch,.-sdes_process_switch\n"
+);
+#else
+static ucontext_t loop_ctx;
+#endif
+
+static size_t stack_mapping_size(void) {
+    return PROCESS_STACK_SIZE + sys_page_size();
+}
+
+static char *stack_acquire(void) {
+    if (free_count > 0)
+        return free_stacks[--free_count];
+
+    char *base = mmap(NULL, stack_mapping_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+    if (mprotect(base, sys_page_size(), PROT_NONE) != 0) {    // guard page: overflow faults instead of corrupting
+        munmap(base, stack_mapping_size());
+        return NULL;
+    }
+    return base;
+}
+
+static void stack_release(char *base) {
+    if (free_count == free_capacity) {
+        size_t capacity = free_capacity ? free_capacity * 2 : 64;
+        char **grown = realloc(free_stacks, sizeof(char *) * capacity);
+        if (!grown) {
+            munmap(base, stack_mapping_size());
+            return;
+        }
+        free_stacks = grown;
+        free_capacity = capacity;
+    }
+    free_stacks[free_count++] = base;
+}
+
+// switch from the process back to the event loop
+static void process_yield(SimProcess *p) {
+#ifdef PROCESS_ASM_SWITCH
+    sdes_process_switch(&p->sp, loop_sp);
+#else
+    swapcontext(&p->ctx, &loop_ctx);
+#endif
+}
+
+// first code run on a fresh stack: run the body, then hand the stack back and never come back
+static void process_entry(void) {
+    SimProcess *p = current_process;
+    p->body(p->arg);
+    p->finished = 1;
+    process_yield(p);
+    abort();    // a finished process is never resumed
+}
+
+static void mailbox_clear(SimProcess *p) {
+    while (p->mailbox_head) {
+        SimMessage *msg = p->mailbox_head;
+        p->mailbox_head = msg->next;
+        free(msg);
+    }
+    p->mailbox_tail = NULL;
+}
+
+// free the record once nothing can reach it any more: body returned, handle released, no delivery pending
+static void process_try_free(SimProcess *p) {
+    if (!p->finished || !p->released || p->messages_in_flight > 0)
+        return;
+    if (p->prev)
+        p->prev->next = p->next;
+    else
+        all_processes = p->next;
+    if (p->next)
+        p->next->prev = p->prev;
+    free(p);
+}
+
+/* switch from the event loop into p and run it until it waits, receives or finishes...
+* only ever called from event tasks, so the loop stack is the one that gets saved.
+* A finished process gives its stack back to the pool, drops unread messages and, if released, its record.
+*/
+static void process_resume(SimProcess *p) {
+    current_process = p;
+#ifdef PROCESS_ASM_SWITCH
+    sdes_process_switch(&loop_sp, p->sp);
+#else
+    swapcontext(&loop_ctx, &p->ctx);
+#endif
+    current_process = NULL;
+
+    if (p->finished && p->stack) {
+        stack_release(p->stack);
+        p->stack = NULL;
+        mailbox_clear(p);
+        process_try_free(p);
+    }
+}
+
+static void process_resume_task(void *context) {
+    process_resume((SimProcess *)context);
+}
+
+/* prepares the stack so that the first switch into it "returns" into process_entry...
+* x86-64: six zeroed callee-saved registers, then the address of process_entry, then a fake return address.
+* The slot holding process_entry is 16-byte aligned, so process_entry starts with the alignment a call gives.
+*/
+static void process_init_context(SimProcess *p) {
+    char *top = p->stack + stack_mapping_size();
+#ifdef PROCESS_ASM_SWITCH
+    uintptr_t aligned = (uintptr_t)top & ~(uintptr_t)15;
+    void **frame = (void **)(aligned - 8 * sizeof(void *));
+    for (int i = 0; i < 6; i++)
+        frame[i] = NULL;
+    frame[6] = (void *)process_entry;
+    frame[7] = NULL;
+    p->sp = frame;
+#else
+    getcontext(&p->ctx);
+    p->ctx.uc_stack.ss_sp = p->stack + sys_page_size();
+    p->ctx.uc_stack.ss_size = PROCESS_STACK_SIZE;
+    p->ctx.uc_link = NULL;
+    makecontext(&p->ctx, process_entry, 0);
+    (void)top;
+#endif
+}
+
+SimProcess *process_spawn(EventScheduler *scheduler, uint64_t start_time, ProcessBody body, void *arg) {
+    if (!scheduler || !body)
+        return NULL;
+
+    SimProcess *p = calloc(1, sizeof(SimProcess));
+    if (!p)
+        return NULL;
+    p->stack = stack_acquire();
+    if (!p->stack) {
+        free(p);
+        return NULL;
+    }
+    p->body = body;
+    p->arg = arg;
+    p->scheduler = scheduler;
+    process_init_context(p);
+
+    Event *start = event_create(start_time, EVENT_CUSTOM, process_resume_task, p, NULL);
+    if (!start || event_scheduler_push(scheduler, start) != 0) {
+        event_destroy(start);
+        stack_release(p->stack);
+        free(p);
+        return NULL;
+    }
+
+    p->next = all_processes;
+    if (all_processes)
+        all_processes->prev = p;
+    all_processes = p;
+    return p;
+}
+
+int sim_wait(uint64_t dt) {
+    SimProcess *p = current_process;
+    if (!p)
+        return -1;
+
+    Event *wake = event_create(current_sim_time + dt, EVENT_TIMEOUT, process_resume_task, p, NULL);
+    if (!wake || event_scheduler_push(p->scheduler, wake) != 0) {
+        fprintf(stderr, "[Process] Failed to schedule wake-up!\n");
+        event_destroy(wake);
+        return -1;
+    }
+    process_yield(p);
+    return 0;
+}
+
+void *sim_recv(void) {
+    SimProcess *p = current_process;
+    if (!p)
+        return NULL;
+
+    while (!p->mailbox_head) {
+        p->waiting_recv = 1;
+        process_yield(p);
+    }
+
+    SimMessage *msg = p->mailbox_head;
+    p->mailbox_head = msg->next;
+    if (!p->mailbox_head)
+        p->mailbox_tail = NULL;
+    void *payload = msg->payload;
+    free(msg);
+    return payload;
+}
+
+// delivery event: append to the mailbox and wake the receiver if it is blocked in sim_recv
+static void process_deliver_task(void *context) {
+    SimMessage *msg = (SimMessage *)context;
+    SimProcess *dst = msg->dst;
+    dst->messages_in_flight--;
+
+    if (dst->finished) {    // nobody will ever read it
+        free(msg);
+        process_try_free(dst);
+        return;
+    }
+
+    msg->next = NULL;
+    if (dst->mailbox_tail)
+        dst->mailbox_tail->next = msg;
+    else
+        dst->mailbox_head = msg;
+    dst->mailbox_tail = msg;
+
+    if (dst->waiting_recv) {
+        dst->waiting_recv = 0;
+        process_resume(dst);
+    }
+}
+
+int sim_send(SimProcess *dst, uint64_t delay, void *payload) {
+    if (!dst)
+        return -1;
+
+    SimMessage *msg = malloc(sizeof(SimMessage));
+    if (!msg)
+        return -1;
+    msg->payload = payload;
+    msg->dst = dst;
+    msg->next = NULL;
+
+    Event *delivery = event_create(current_sim_time + delay, EVENT_PACKET_RECEIVED, process_deliver_task, msg, NULL);
+    if (!delivery || event_scheduler_push(dst->scheduler, delivery) != 0) {
+        event_destroy(delivery);
+        free(msg);
+        return -1;
+    }
+    dst->messages_in_flight++;
+    return 0;
+}
+
+SimProcess *sim_self(void) {
+    return current_process;
+}
+
+int process_finished(const SimProcess *process) {
+    return process ? process->finished : 1;
+}
+
+void process_release(SimProcess *process) {
+    if (!process || process->released)
+        return;
+    process->released = 1;
+    process_try_free(process);
+}
+
+void process_shutdown(void) {
+    while (all_processes) {
+        SimProcess *p = all_processes;
+        all_processes = p->next;
+        mailbox_clear(p);
+        if (p->stack)
+            munmap(p->stack, stack_mapping_size());
+        free(p);
+    }
+
+    while (free_count > 0)
+        munmap(free_stacks[--free_count], stack_mapping_size());
+    free(free_stacks);
+    free_stacks = NULL;
+    free_capacity = 0;
+}
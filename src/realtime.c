@@ -0,0 +1,321 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/prctl.h>
+#include <linux/futex.h>
+#define REALTIME_FUTEX 1
+#endif
+#include "realtime.h"
+#include "event_loop.h"
+#include "packet.h"
+
+static uint64_t wall_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* blocks until wall_ns on the monotonic clock, or until an injection bumps wake_seq away from seen_seq...
+* Linux: FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC timeout and returns at once if the word changed.
+* Elsewhere: sleeps at most max_sleep_ns, so injections are still picked up within one slice.
+*/
+static void wait_until_ns(RealtimeLoop *rt, uint64_t wall_ns, uint32_t seen_seq) {
+#ifdef REALTIME_FUTEX
+    struct timespec ts;
+    ts.tv_sec = (time_t)(wall_ns / 1000000000ull);
+    ts.tv_nsec = (long)(wall_ns % 1000000000ull);
+    syscall(SYS_futex, (uint32_t *)&rt->wake_seq, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, seen_seq, &ts, NULL,
+            FUTEX_BITSET_MATCH_ANY);
+#else
+    (void)seen_seq;
+    uint64_t now = wall_now_ns();
+    if (wall_ns > now + rt->max_sleep_ns)
+        wall_ns = now + rt->max_sleep_ns;
+    struct timespec ts;
+    ts.tv_sec = (time_t)(wall_ns / 1000000000ull);
+    ts.tv_nsec = (long)(wall_ns % 1000000000ull);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+#endif
+}
+
+// producer side: bump the sequence, and make the syscall only if the loop is actually asleep
+static void wake_loop(RealtimeLoop *rt) {
+    atomic_fetch_add(&rt->wake_seq, 1);
+#ifdef REALTIME_FUTEX
+    if (atomic_load(&rt->sleeping))
+        syscall(SYS_futex, (uint32_t *)&rt->wake_seq, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+#endif
+}
+
+RealtimeLoop *realtime_create(uint64_t ns_per_tick) {
+    RealtimeLoop *rt = calloc(1, sizeof(RealtimeLoop));
+    if (!rt)
+        return NULL;
+    rt->stub.event = NULL;
+    atomic_init(&rt->stub.next, NULL);
+    atomic_init(&rt->tail, &rt->stub);
+    rt->head = &rt->stub;
+
+    rt->ns_per_tick = ns_per_tick ? ns_per_tick : 1;
+    rt->spin_ns = 50000;    // 50 us
+    rt->max_sleep_ns = 1000000;    // 1 ms, only without futex
+    rt->miss_tolerance_ns = 100000;    // 100 us
+    atomic_init(&rt->stop, 0);
+    atomic_init(&rt->wake_seq, 0);
+    atomic_init(&rt->sleeping, 0);
+    atomic_init(&rt->start_wall_ns, 0);
+    atomic_init(&rt->start_time, 0);
+    return rt;
+}
+
+/* ---- the MPSC queue ----
+* push: a producer swaps itself in as the new tail, then links the previous tail to it.
+*       Between the two steps the list is briefly cut; the consumer then just sees "empty" and retries next time.
+* pop:  the consumer walks from head; the stub node keeps the list non-empty so head never has to meet tail.
+*/
+static void mpsc_push(RealtimeLoop *rt, RtInjectNode *node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    RtInjectNode *prev = atomic_exchange_explicit(&rt->tail, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+static RtInjectNode *mpsc_pop(RealtimeLoop *rt) {
+    RtInjectNode *head = rt->head;
+    RtInjectNode *next = atomic_load_explicit(&head->next, memory_order_acquire);
+
+    if (head == &rt->stub) {
+        if (!next)
+            return NULL;
+        rt->head = next;
+        head = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next) {
+        rt->head = next;
+        return head;
+    }
+    if (head != atomic_load_explicit(&rt->tail, memory_order_acquire))
+        return NULL;    // a producer is between its two steps
+
+    mpsc_push(rt, &rt->stub);
+    next = atomic_load_explicit(&head->next, memory_order_acquire);
+    if (next) {
+        rt->head = next;
+        return head;
+    }
+    return NULL;
+}
+
+static void inject_node_destroy(RtInjectNode *node) {
+    packet_destroy(node->event->packet);
+    event_destroy(node->event);
+    free(node);
+}
+
+void realtime_destroy(RealtimeLoop *rt) {
+    if (!rt)
+        return;
+    RtInjectNode *node;
+    while ((node = mpsc_pop(rt)) != NULL)
+        inject_node_destroy(node);
+    while ((node = rt->due_head) != NULL) {
+        rt->due_head = atomic_load_explicit(&node->next, memory_order_relaxed);
+        inject_node_destroy(node);
+    }
+    rt->due_tail = NULL;
+    free(rt);
+}
+
+int realtime_inject(RealtimeLoop *rt, Event *ev) {
+    if (!rt || !ev)
+        return -1;
+    RtInjectNode *node = malloc(sizeof(RtInjectNode));
+    if (!node)
+        return -1;
+    node->event = ev;
+    node->injected_wall_ns = wall_now_ns();
+    mpsc_push(rt, node);
+    wake_loop(rt);
+    return 0;
+}
+
+uint64_t realtime_now(RealtimeLoop *rt) {
+    uint64_t start_wall = atomic_load(&rt->start_wall_ns);
+    if (!start_wall)
+        return 0;
+    return atomic_load(&rt->start_time) + (wall_now_ns() - start_wall) / rt->ns_per_tick;
+}
+
+void realtime_stop(RealtimeLoop *rt) {
+    atomic_store(&rt->stop, 1);
+    wake_loop(rt);
+}
+
+static uint64_t deadline_of(RealtimeLoop *rt, uint64_t start_wall, uint64_t start_time, uint64_t time) {
+    uint64_t ticks = time > start_time ? time - start_time : 0;
+    if (ticks > (UINT64_MAX - start_wall) / rt->ns_per_tick)
+        return UINT64_MAX;
+    return start_wall + ticks * rt->ns_per_tick;
+}
+
+/* merges everything the producers queued so far...
+* 1. Events in the past are moved to the current time (the clock never runs backwards).
+* 2. Events whose deadline is still ahead go into the scheduler and are paced like any other event.
+* 3. Events already due go into the due list, in arrival order: they cannot be on time, so they are measured
+*    by their injection-to-dispatch delay instead of counting as deadline misses.
+*/
+static void realtime_drain(RealtimeLoop *rt, EventScheduler *scheduler, uint64_t start_wall, uint64_t start_time) {
+    RtInjectNode *node;
+    uint64_t now = wall_now_ns();
+    while ((node = mpsc_pop(rt)) != NULL) {
+        Event *ev = node->event;
+        rt->injected++;
+        if (ev->time < current_sim_time) {
+            ev->time = current_sim_time;
+            rt->late_injections++;
+        }
+
+        if (deadline_of(rt, start_wall, start_time, ev->time) <= now) {
+            // the due list reuses `next`; it is private to the loop thread, so relaxed accesses are enough
+            atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+            if (rt->due_tail)
+                atomic_store_explicit(&rt->due_tail->next, node, memory_order_relaxed);
+            else
+                rt->due_head = node;
+            rt->due_tail = node;
+            continue;
+        }
+
+        free(node);
+        if (event_scheduler_push(scheduler, ev) != 0) {
+            rt->dropped++;
+            packet_destroy(ev->packet);
+            event_destroy(ev);
+        }
+    }
+}
+
+static void record_delay(RtDelayStats *stats, uint64_t delay) {
+    stats->count++;
+    if (delay > stats->max_ns)
+        stats->max_ns = delay;
+    double delta = (double)delay - stats->mean_ns;
+    stats->mean_ns += delta / stats->count;
+    stats->m2 += delta * ((double)delay - stats->mean_ns);
+}
+
+/* the paced loop...
+* 1. Pins simulation time current_sim_time to the wall clock now.
+* 2. Every iteration merges the injected events, then runs a due injection if it is not later than the earliest
+*    scheduled event; otherwise it works out the wall-clock deadline of that event (or of until_time).
+* 3. Far from the deadline it blocks until spin_ns before it, or until an injection wakes it up;
+*    within spin_ns of it, it spins.
+* 4. At the deadline it pops and dispatches the event exactly like event_loop_run, and records how late it ran.
+*/
+uint64_t realtime_run(RealtimeLoop *rt, EventScheduler *scheduler, uint64_t until_time) {
+    if (!rt || !scheduler)
+        return 0;
+
+    uint64_t start_time = current_sim_time;
+    uint64_t start_wall = wall_now_ns();
+    atomic_store(&rt->start_time, start_time);
+    atomic_store(&rt->start_wall_ns, start_wall);
+    atomic_store(&rt->stop, 0);
+    uint64_t executed = 0;
+
+    /* the kernel may fire a timed wait up to the thread's timer slack late (50 us by default, as large as spin_ns),
+    * so drop the slack to 1 ns for the run; if that is refused, widen the spin window past the slack instead.
+    */
+    uint64_t spin_ns = rt->spin_ns;
+#ifdef REALTIME_FUTEX
+    int saved_slack = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    if (prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0) != 0 && saved_slack > 0)
+        spin_ns += (uint64_t)saved_slack;
+#endif
+
+    while (!atomic_load_explicit(&rt->stop, memory_order_relaxed)) {
+        uint32_t seq = atomic_load(&rt->wake_seq);
+        realtime_drain(rt, scheduler, start_wall, start_time);
+
+        int have_event = scheduler->size > 0 && scheduler->heap[0]->time <= until_time;
+        RtInjectNode *due = rt->due_head;
+        if (due && due->event->time <= until_time && (!have_event || due->event->time <= scheduler->heap[0]->time)) {
+            rt->due_head = atomic_load_explicit(&due->next, memory_order_relaxed);
+            if (!rt->due_head)
+                rt->due_tail = NULL;
+            Event *ev = due->event;
+            if (ev->time < current_sim_time)    // overtaken by an earlier arrival with a later time
+                ev->time = current_sim_time;
+            record_delay(&rt->injection_delay, wall_now_ns() - due->injected_wall_ns);
+            free(due);
+            rt->events++;
+            event_loop_dispatch(ev);
+            executed++;
+            continue;
+        }
+
+        uint64_t target = have_event ? scheduler->heap[0]->time : until_time;
+        uint64_t deadline = deadline_of(rt, start_wall, start_time, target);
+        uint64_t now = wall_now_ns();
+
+        if (now < deadline) {
+            if (deadline - now > spin_ns) {
+                // announce the sleep first, then re-check: an injection in between either sees `sleeping`
+                // or has already bumped wake_seq, so it is never missed
+                atomic_store(&rt->sleeping, 1);
+                if (atomic_load(&rt->wake_seq) == seq)
+                    wait_until_ns(rt, deadline - spin_ns, seq);
+                atomic_store(&rt->sleeping, 0);
+                continue;
+            }
+            while ((now = wall_now_ns()) < deadline)
+                ;
+        }
+
+        if (!have_event) {    // until_time reached on the wall clock
+            current_sim_time = until_time;
+            break;
+        }
+
+        Event *ev = event_scheduler_pop(scheduler);
+        uint64_t lateness = wall_now_ns() - deadline;
+        record_delay(&rt->lateness, lateness);
+        if (lateness > rt->miss_tolerance_ns)
+            rt->misses++;
+        rt->events++;
+        event_loop_dispatch(ev);
+        executed++;
+    }
+
+#ifdef REALTIME_FUTEX
+    if (saved_slack > 0)
+        prctl(PR_SET_TIMERSLACK, (unsigned long)saved_slack, 0, 0, 0);
+#endif
+    atomic_store(&rt->start_wall_ns, 0);
+    return executed;
+}
+
+static void print_delay_stats(const char *label, const RtDelayStats *stats) {
+    double stddev = stats->count > 1 ? sqrt(stats->m2 / (stats->count - 1)) : 0.0;
+    printf("  %s mean: %.1f ns, stddev: %.1f ns, max: %llu ns\n",
+           label, stats->mean_ns, stddev, (unsigned long long)stats->max_ns);
+}
+
+void realtime_print_stats(RealtimeLoop *rt) {
+    printf("\n=== REAL-TIME PACING STATISTICS ===\n");
+    printf("  Wall-clock ns per time unit: %llu\n", (unsigned long long)rt->ns_per_tick);
+    printf("  Events executed: %llu (scheduled: %llu, injected already due: %llu)\n", (unsigned long long)rt->events,
+           (unsigned long long)rt->lateness.count, (unsigned long long)rt->injection_delay.count);
+    printf("  Events injected: %llu (late: %llu, dropped: %llu)\n", (unsigned long long)rt->injected,
+           (unsigned long long)rt->late_injections, (unsigned long long)rt->dropped);
+    printf("  Deadline misses (> %llu ns): %llu of %llu\n", (unsigned long long)rt->miss_tolerance_ns,
+           (unsigned long long)rt->misses, (unsigned long long)rt->lateness.count);
+    if (rt->lateness.count > 0)
+        print_delay_stats("Lateness", &rt->lateness);
+    if (rt->injection_delay.count > 0)
+        print_delay_stats("Injection to dispatch", &rt->injection_delay);
+}
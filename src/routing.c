@@ -0,0 +1,473 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "routing.h"
+
+Topology *topology_create(uint32_t n_nodes, const uint32_t *from, const uint32_t *to, const uint32_t *delay, uint32_t n_edges) {
+    if (n_nodes == 0 || (n_edges > 0 && (!from || !to || !delay)))
+        return NULL;
+    for (uint32_t i = 0; i < n_edges; i++) {
+        if (from[i] >= n_nodes || to[i] >= n_nodes)
+            return NULL;
+    }
+
+    Topology *topo = calloc(1, sizeof(Topology));
+    if (!topo)
+        return NULL;
+    topo->n_nodes = n_nodes;
+    topo->n_edges = n_edges;
+    topo->row_start = calloc((size_t)n_nodes + 1, sizeof(uint32_t));
+    topo->edge_to = malloc(sizeof(uint32_t) * (n_edges ? n_edges : 1));
+    topo->edge_delay = malloc(sizeof(uint32_t) * (n_edges ? n_edges : 1));
+    if (!topo->row_start || !topo->edge_to || !topo->edge_delay) {
+        topology_destroy(topo);
+        return NULL;
+    }
+
+    // counting sort by tail node: count, prefix sum, scatter
+    for (uint32_t i = 0; i < n_edges; i++)
+        topo->row_start[from[i] + 1]++;
+    for (uint32_t u = 0; u < n_nodes; u++)
+        topo->row_start[u + 1] += topo->row_start[u];
+
+    uint32_t *fill = malloc(sizeof(uint32_t) * n_nodes);
+    if (!fill) {
+        topology_destroy(topo);
+        return NULL;
+    }
+    for (uint32_t u = 0; u < n_nodes; u++)
+        fill[u] = topo->row_start[u];
+    for (uint32_t i = 0; i < n_edges; i++) {
+        uint32_t e = fill[from[i]]++;
+        topo->edge_to[e] = to[i];
+        topo->edge_delay[e] = delay[i];
+    }
+    free(fill);
+    return topo;
+}
+
+void topology_destroy(Topology *topo) {
+    if (!topo)
+        return;
+    free(topo->row_start);
+    free(topo->edge_to);
+    free(topo->edge_delay);
+    free(topo);
+}
+
+// the next blank-separated unsigned decimal field (no sign), advancing *p; 0 on success
+static int next_field(const char **p, unsigned long long *value) {
+    const char *s = *p;
+    while (*s == ' ' || *s == '\t')
+        s++;
+    if (!isdigit((unsigned char)*s))
+        return -1;    // strtoull would also take signs
+    char *end;
+    errno = 0;
+    *value = strtoull(s, &end, 10);
+    if (errno || (*end && !isspace((unsigned char)*end)))
+        return -1;
+    *p = end;
+    return 0;
+}
+
+static int rest_is_blank(const char *p) {
+    while (isspace((unsigned char)*p))
+        p++;
+    return *p == '\0';
+}
+
+/* the loader...
+* 1. Skips blank lines and comment lines (first non-blank character '#').
+* 2. Takes an optional "nodes N" line before the first edge; node ids must then be below N, otherwise below
+*    TOPOLOGY_MAX_NODES (the node count is max id + 1, and every node costs a CSR row and a forwarding table row).
+* 3. Parses every edge line strictly as "from to delay" with a positive delay; anything else is an error with
+*    its line number, so a typo cannot silently drop a link or blow up the node count.
+*/
+Topology *topology_load(const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return NULL;
+    }
+
+    size_t n = 0, capacity = 1024;
+    uint32_t *from = malloc(sizeof(uint32_t) * capacity);
+    uint32_t *to = malloc(sizeof(uint32_t) * capacity);
+    uint32_t *delay = malloc(sizeof(uint32_t) * capacity);
+    uint32_t n_nodes = 0;
+    Topology *topo = NULL;
+    char line[256];
+    size_t line_no = 0;
+
+    unsigned long long node_limit = TOPOLOGY_MAX_NODES;
+    int declared = 0;
+
+    while (from && to && delay && fgets(line, sizeof(line), in)) {
+        line_no++;
+        if (!strchr(line, '\n') && !feof(in)) {
+            fprintf(stderr, "[Routing] %s:%zu: line too long\n", path, line_no);
+            goto done;
+        }
+        const char *p = line;
+        while (isspace((unsigned char)*p))
+            p++;
+        if (*p == '\0' || *p == '#')
+            continue;
+
+        if (strncmp(p, "nodes", 5) == 0 && isspace((unsigned char)p[5])) {
+            p += 5;
+            unsigned long long count;
+            if (declared || n > 0 || next_field(&p, &count) != 0 || !rest_is_blank(p) ||
+                count == 0 || count >= UINT32_MAX) {
+                fprintf(stderr, "[Routing] %s:%zu: expected one 'nodes N' line (0 < N < 2^32 - 1) before the edges\n",
+                        path, line_no);
+                goto done;
+            }
+            node_limit = count;
+            n_nodes = (uint32_t)count;
+            declared = 1;
+            continue;
+        }
+
+        unsigned long long u, v, d;
+        if (next_field(&p, &u) != 0 || next_field(&p, &v) != 0 || next_field(&p, &d) != 0 || !rest_is_blank(p)) {
+            fprintf(stderr, "[Routing] %s:%zu: expected 'from to delay'\n", path, line_no);
+            goto done;
+        }
+        if (u >= node_limit || v >= node_limit) {
+            fprintf(stderr, "[Routing] %s:%zu: node id %llu out of range (%s %llu)\n", path, line_no,
+                    u >= node_limit ? u : v, declared ? "nodes" : "no 'nodes' line, limit", node_limit);
+            goto done;
+        }
+        if (d == 0 || d > UINT32_MAX) {
+            fprintf(stderr, "[Routing] %s:%zu: link delay %llu out of range (1 .. %u)\n", path, line_no, d, UINT32_MAX);
+            goto done;
+        }
+
+        if (n == capacity) {
+            capacity *= 2;
+            uint32_t *nf = realloc(from, sizeof(uint32_t) * capacity);
+            if (nf) from = nf;
+            uint32_t *nt = realloc(to, sizeof(uint32_t) * capacity);
+            if (nt) to = nt;
+            uint32_t *nd = realloc(delay, sizeof(uint32_t) * capacity);
+            if (nd) delay = nd;
+            if (!nf || !nt || !nd)
+                goto done;
+        }
+        from[n] = (uint32_t)u;
+        to[n] = (uint32_t)v;
+        delay[n] = (uint32_t)d;
+        n++;
+        if (!declared) {
+            if (u + 1 > n_nodes) n_nodes = (uint32_t)(u + 1);
+            if (v + 1 > n_nodes) n_nodes = (uint32_t)(v + 1);
+        }
+    }
+
+    if (n > UINT32_MAX)
+        fprintf(stderr, "[Routing] %s: too many edges\n", path);
+    else
+        topo = topology_create(n_nodes, from, to, delay, (uint32_t)n);
+    if (!topo)
+        fprintf(stderr, "[Routing] %s: empty or invalid topology\n", path);
+
+done:
+    fclose(in);
+    free(from);
+    free(to);
+    free(delay);
+    return topo;
+}
+
+Topology *topology_create_random(uint32_t n_nodes, uint32_t degree, uint32_t min_delay, uint32_t max_delay) {
+    if (n_nodes < 2 || max_delay < min_delay)
+        return NULL;
+    uint32_t chords = degree > 2 ? (degree - 2) / 2 : 0;
+    size_t n_edges = 2 * (size_t)n_nodes * (1 + chords);
+    if (n_edges > UINT32_MAX)
+        return NULL;
+
+    uint32_t *from = malloc(sizeof(uint32_t) * n_edges);
+    uint32_t *to = malloc(sizeof(uint32_t) * n_edges);
+    uint32_t *delay = malloc(sizeof(uint32_t) * n_edges);
+    Topology *topo = NULL;
+    if (!from || !to || !delay)
+        goto done;
+
+    size_t k = 0;
+    for (uint32_t u = 0; u < n_nodes; u++) {
+        for (uint32_t c = 0; c <= chords; c++) {
+            // the first link of every node closes the ring, the others go anywhere
+            uint32_t v = c == 0 ? (u + 1) % n_nodes
+                                : (uint32_t)(((uint64_t)rand() * RAND_MAX + rand()) % n_nodes);
+            if (v == u)
+                v = (u + 1) % n_nodes;
+            uint32_t d = min_delay + (uint32_t)(rand() % ((uint64_t)max_delay - min_delay + 1));
+            from[k] = u; to[k] = v; delay[k] = d; k++;
+            from[k] = v; to[k] = u; delay[k] = d; k++;
+        }
+    }
+    topo = topology_create(n_nodes, from, to, delay, (uint32_t)n_edges);
+
+done:
+    free(from);
+    free(to);
+    free(delay);
+    return topo;
+}
+
+/* ---- forwarding table construction ---- */
+
+typedef struct {
+    uint64_t dist;
+    uint32_t node;
+} HeapEntry;
+
+typedef struct {
+    const Topology *topo;
+    const uint32_t *rrow_start;    // reversed graph: edges entering v are rrow_start[v] .. rrow_start[v + 1] - 1
+    const uint32_t *redge;    // ... given as the id of the original edge
+    const uint32_t *rfrom;    // ... and its tail node
+    const ForwardingTable *fib;
+    uint32_t *columns;    // column-major scratch: [slot * n_nodes + node]
+    atomic_uint next_slot;    // next destination to hand out (only taken by workers that have their buffers)
+    uint32_t n_threads;
+} RouteBuild;
+
+typedef struct {
+    RouteBuild *build;
+    uint32_t index;    // thread index, for the transpose phase
+} RouteWorker;
+
+static void heap_push(HeapEntry *heap, size_t *size, uint64_t dist, uint32_t node) {
+    size_t i = (*size)++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent].dist <= dist)
+            break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i].dist = dist;
+    heap[i].node = node;
+}
+
+static HeapEntry heap_pop(HeapEntry *heap, size_t *size) {
+    HeapEntry top = heap[0];
+    HeapEntry last = heap[--(*size)];
+    size_t i = 0;
+    while (1) {
+        size_t child = i * 2 + 1;
+        if (child >= *size)
+            break;
+        if (child + 1 < *size && heap[child + 1].dist < heap[child].dist)
+            child++;
+        if (last.dist <= heap[child].dist)
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*size > 0)
+        heap[i] = last;
+    return top;
+}
+
+/* phase 1, one Dijkstra per destination...
+* Runs on the reversed graph from the destination, so dist[u] is the distance from u to the destination.
+* Whenever the edge u -> v improves dist[u], that edge becomes u's next hop (written into the destination's column).
+* Each thread owns whole columns, so there is no sharing between threads while they run.
+*/
+static void *route_columns_worker(void *arg) {
+    RouteWorker *worker = (RouteWorker *)arg;
+    RouteBuild *build = worker->build;
+    const Topology *topo = build->topo;
+    uint32_t n = topo->n_nodes;
+
+    uint64_t *dist = malloc(sizeof(uint64_t) * n);
+    HeapEntry *heap = malloc(sizeof(HeapEntry) * ((size_t)topo->n_edges + 1));
+    if (!dist || !heap) {    // the other workers pick up the remaining destinations
+        free(dist);
+        free(heap);
+        return NULL;
+    }
+
+    uint32_t slot;
+    while ((slot = atomic_fetch_add(&build->next_slot, 1)) < build->fib->n_dests) {
+        uint32_t *column = build->columns + (size_t)slot * n;
+        uint32_t dest = build->fib->dests[slot];
+        for (uint32_t u = 0; u < n; u++) {
+            dist[u] = UINT64_MAX;
+            column[u] = ROUTE_NONE;
+        }
+
+        size_t size = 0;
+        dist[dest] = 0;
+        heap_push(heap, &size, 0, dest);
+        while (size > 0) {
+            HeapEntry top = heap_pop(heap, &size);
+            uint32_t v = top.node;
+            if (top.dist > dist[v])
+                continue;    // stale entry
+            for (uint32_t k = build->rrow_start[v]; k < build->rrow_start[v + 1]; k++) {
+                uint32_t u = build->rfrom[k];
+                uint32_t e = build->redge[k];
+                uint64_t nd = top.dist + topo->edge_delay[e];
+                if (nd < dist[u]) {
+                    dist[u] = nd;
+                    column[u] = e;
+                    heap_push(heap, &size, nd, u);
+                }
+            }
+        }
+    }
+
+    free(dist);
+    free(heap);
+    return NULL;
+}
+
+// phase 2: transpose the columns into the row-major table, one block of nodes per thread,
+// resolving each edge to its head node and delay so that a hop never has to touch the topology
+static void *route_transpose_worker(void *arg) {
+    RouteWorker *worker = (RouteWorker *)arg;
+    RouteBuild *build = worker->build;
+    const Topology *topo = build->topo;
+    const ForwardingTable *fib = build->fib;
+    uint32_t n = fib->n_nodes;
+    uint32_t block = (n + build->n_threads - 1) / build->n_threads;
+    uint64_t first = (uint64_t)worker->index * block;
+    uint64_t last = first + block < n ? first + block : n;
+
+    for (uint64_t u = first; u < last; u++) {
+        RouteEntry *row = fib->next_hop + u * fib->n_dests;
+        for (uint32_t slot = 0; slot < fib->n_dests; slot++) {
+            uint32_t e = build->columns[(size_t)slot * n + u];
+            row[slot].next = e == ROUTE_NONE ? ROUTE_NONE : topo->edge_to[e];
+            row[slot].delay = e == ROUTE_NONE ? 0 : topo->edge_delay[e];
+        }
+    }
+    return NULL;
+}
+
+static int run_workers(RouteBuild *build, void *(*fn)(void *)) {
+    RouteWorker *workers = malloc(sizeof(RouteWorker) * build->n_threads);
+    pthread_t *threads = malloc(sizeof(pthread_t) * build->n_threads);
+    if (!workers || !threads) {
+        free(workers);
+        free(threads);
+        return -1;
+    }
+
+    uint32_t started = 0;
+    for (uint32_t i = 0; i < build->n_threads; i++) {
+        workers[i].build = build;
+        workers[i].index = i;
+        if (i > 0 && pthread_create(&threads[i], NULL, fn, &workers[i]) == 0)
+            started = i;
+        else if (i > 0)
+            break;
+    }
+    fn(&workers[0]);    // the calling thread works too
+    for (uint32_t i = 1; i <= started; i++)
+        pthread_join(threads[i], NULL);
+
+    free(workers);
+    free(threads);
+    return started + 1 == build->n_threads ? 0 : -1;
+}
+
+/* forwarding table construction...
+* 1. Builds the reversed CSR (edges grouped by head node, keeping the original edge ids).
+* 2. Phase 1: threads pull destinations from a shared counter and fill one column each (route_columns_worker).
+* 3. Phase 2: threads transpose disjoint node blocks into the final row-major table of (next node, delay) entries.
+*/
+ForwardingTable *forwarding_table_build(const Topology *topo, const uint32_t *dests, uint32_t n_dests, int n_threads) {
+    if (!topo || !dests || n_dests == 0)
+        return NULL;
+    uint32_t n = topo->n_nodes;
+    for (uint32_t i = 0; i < n_dests; i++) {
+        if (dests[i] >= n)
+            return NULL;
+    }
+    if (n_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if ((uint32_t)n_threads > n_dests)
+        n_threads = (int)n_dests;
+
+    ForwardingTable *fib = calloc(1, sizeof(ForwardingTable));
+    uint32_t *rrow_start = calloc((size_t)n + 1, sizeof(uint32_t));
+    uint32_t *redge = malloc(sizeof(uint32_t) * (topo->n_edges ? topo->n_edges : 1));
+    uint32_t *rfrom = malloc(sizeof(uint32_t) * (topo->n_edges ? topo->n_edges : 1));
+    uint32_t *fill = malloc(sizeof(uint32_t) * n);
+    uint32_t *columns = malloc(sizeof(uint32_t) * (size_t)n * n_dests);
+    if (fib) {
+        fib->n_nodes = n;
+        fib->n_dests = n_dests;
+        fib->dests = malloc(sizeof(uint32_t) * n_dests);
+        fib->next_hop = malloc(sizeof(RouteEntry) * (size_t)n * n_dests);
+    }
+    if (!fib || !fib->dests || !fib->next_hop || !rrow_start || !redge || !rfrom || !fill || !columns) {
+        forwarding_table_destroy(fib);
+        fib = NULL;
+        goto done;
+    }
+    for (uint32_t i = 0; i < n_dests; i++)
+        fib->dests[i] = dests[i];
+
+    for (uint32_t e = 0; e < topo->n_edges; e++)
+        rrow_start[topo->edge_to[e] + 1]++;
+    for (uint32_t v = 0; v < n; v++)
+        rrow_start[v + 1] += rrow_start[v];
+    for (uint32_t v = 0; v < n; v++)
+        fill[v] = rrow_start[v];
+    for (uint32_t u = 0; u < n; u++) {
+        for (uint32_t e = topo->row_start[u]; e < topo->row_start[u + 1]; e++) {
+            uint32_t k = fill[topo->edge_to[e]]++;
+            redge[k] = e;
+            rfrom[k] = u;
+        }
+    }
+
+    RouteBuild build;
+    build.topo = topo;
+    build.rrow_start = rrow_start;
+    build.redge = redge;
+    build.rfrom = rfrom;
+    build.fib = fib;
+    build.columns = columns;
+    atomic_init(&build.next_slot, 0);
+    build.n_threads = (uint32_t)n_threads;
+
+    // a thread that failed to start is covered by the others in phase 1, but not in phase 2
+    run_workers(&build, route_columns_worker);
+    if (atomic_load(&build.next_slot) < n_dests ||
+        run_workers(&build, route_transpose_worker) != 0) {
+        forwarding_table_destroy(fib);
+        fib = NULL;
+    }
+
+done:
+    free(rrow_start);
+    free(redge);
+    free(rfrom);
+    free(fill);
+    free(columns);
+    return fib;
+}
+
+void forwarding_table_destroy(ForwardingTable *fib) {
+    if (!fib)
+        return;
+    free(fib->dests);
+    free(fib->next_hop);
+    free(fib);
+}
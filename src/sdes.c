@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdes.h"
+#include "event.h"
+#include "event_scheduler.h"
+#include "event_loop.h"
+#include "network_sim.h"
+#include "packet.h"
+#include "trace.h"
+#include "distribution.h"
+
+// SdesSenderMode mirrors SenderMode so that the public header does not need network_sim.h
+_Static_assert((int)SDES_SENDER_FIXED_INTERVAL == (int)SENDER_FIXED_INTERVAL &&
+               (int)SDES_SENDER_EXPONENTIAL == (int)SENDER_EXPONENTIAL &&
+               (int)SDES_SENDER_TRACE == (int)SENDER_TRACE, "SdesSenderMode out of sync with SenderMode");
+
+struct SdesSim {
+    EventScheduler *scheduler;
+    SenderContext *sender;
+    NetworkContext *network;
+    ReceiverContext *receiver;
+    TraceFile *trace;             // owned, only in SENDER_TRACE mode
+    uint64_t now;                 // clock of this simulation while it is not running
+    int running;                  // inside sdes_run*, current_sim_time is the clock
+    uint64_t events_processed;
+    uint64_t packets_injected;
+    int verbose;
+};
+
+// the core works on globals, so every entry point swaps this simulation in and out
+typedef struct {
+    EventScheduler *scheduler;
+    uint64_t time;
+    int verbose;
+} SavedGlobals;
+
+static void sim_enter(SdesSim *sim, SavedGlobals *saved) {
+    saved->scheduler = global_scheduler;
+    saved->time = current_sim_time;
+    saved->verbose = network_sim_verbose;
+    global_scheduler = sim->scheduler;
+    current_sim_time = sim->now;
+    network_sim_verbose = sim->verbose;
+}
+
+static void sim_leave(SdesSim *sim, const SavedGlobals *saved) {
+    sim->now = current_sim_time;
+    global_scheduler = saved->scheduler;
+    current_sim_time = saved->time;
+    network_sim_verbose = saved->verbose;
+}
+
+// the live clock: a task injecting during sdes_run* sees the running time, not the one saved at entry
+static uint64_t sdes_clock(const SdesSim *sim) {
+    return sim->running ? current_sim_time : sim->now;
+}
+
+// the public sdes_inject_event plus the internal events of the built-in sender and network
+static int schedule_event(SdesSim *sim, uint64_t time, EventType type, EventTask task, void *context, Packet *packet) {
+    if (!sim || time < sdes_clock(sim))
+        return -1;
+    Event *ev = event_create(time, type, task, context, packet);
+    if (!ev)
+        return -1;
+    if (event_scheduler_push(sim->scheduler, ev) != 0) {
+        event_destroy(ev);
+        return -1;
+    }
+    return 0;
+}
+
+int sdes_config_init(SdesConfig *cfg, size_t size) {
+    if (!cfg || size < SDES_CONFIG_SIZE_MIN || size > sizeof(SdesConfig))
+        return -1;
+    SdesConfig defaults;
+    memset(&defaults, 0, sizeof(defaults));
+    defaults.size = size;
+    defaults.mode = SDES_SENDER_FIXED_INTERVAL;
+    defaults.interval = 100;
+    defaults.finish_time = 2000;
+    defaults.lambda = 0.01;
+    defaults.min_delay = 10;
+    defaults.max_delay = 50;
+    defaults.packet_size = 512;
+    defaults.capacity = 0;
+    defaults.seed = 0;
+    defaults.verbose = 0;
+    defaults.trace_path = NULL;
+    defaults.delay_dist = NULL;
+    defaults.size_dist = NULL;
+    memcpy(cfg, &defaults, size);
+    return 0;
+}
+
+/* same wiring as run_network_simulation, but nothing is run and nothing is printed:
+* 0. Copies the caller's config over the defaults, as far as its size says.
+* 1. Creates the scheduler and the receiver/network/sender components and links them.
+* 2. In SENDER_TRACE mode opens the trace and hands it to the sender.
+* 3. Schedules the initial sender event if the sender has something to do.
+*/
+SdesSim *sdes_create(const SdesConfig *user_cfg) {
+    // fields the caller's header does not know about keep their defaults
+    SdesConfig full;
+    sdes_config_default(&full);
+    if (user_cfg) {
+        if (user_cfg->size < SDES_CONFIG_SIZE_MIN || user_cfg->size > sizeof(SdesConfig))
+            return NULL;
+        memcpy(&full, user_cfg, user_cfg->size);
+    }
+    const SdesConfig *cfg = &full;
+
+    SdesSim *sim = calloc(1, sizeof(SdesSim));
+    if (!sim)
+        return NULL;
+
+    if (cfg->seed)
+        srand(cfg->seed);
+
+    sim->verbose = cfg->verbose;
+    sim->scheduler = event_scheduler_create(cfg->capacity ? cfg->capacity : 10000);
+    sim->receiver = receiver_create();
+    sim->network = network_create(cfg->min_delay, cfg->max_delay);
+    uint64_t finish_time = cfg->finish_time;
+    if (cfg->mode == SDES_SENDER_TRACE && finish_time == 0)
+        finish_time = UINT64_MAX;
+    sim->sender = sender_create(cfg->interval, finish_time, (SenderMode)cfg->mode, cfg->lambda, cfg->packet_size);
+    if (!sim->scheduler || !sim->receiver || !sim->network || !sim->sender) {
+        sdes_destroy(sim);
+        return NULL;
+    }
+
+    sim->network->receiver = sim->receiver;
+    sim->sender->network = sim->network;
+    network_set_delay_distribution(sim->network, cfg->delay_dist);
+    sender_set_size_distribution(sim->sender, cfg->size_dist);
+
+    if (cfg->mode == SDES_SENDER_TRACE) {
+        sim->trace = cfg->trace_path ? trace_open(cfg->trace_path) : NULL;
+        if (!sim->trace) {
+            sdes_destroy(sim);
+            return NULL;
+        }
+        sender_set_trace(sim->sender, sim->trace);
+    }
+
+    if (finish_time > 0 && schedule_event(sim, sender_first_send_time(sim->sender), EVENT_SEND_PACKET,
+                                             sender_task, sim->sender, NULL) != 0) {
+        sdes_destroy(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+// events still pending own their packets, so drain them before freeing the components
+void sdes_destroy(SdesSim *sim) {
+    if (!sim)
+        return;
+    event_scheduler_clear(sim->scheduler);
+    event_scheduler_destroy(sim->scheduler);
+    sender_destroy(sim->sender);
+    network_destroy(sim->network);
+    receiver_destroy(sim->receiver);
+    trace_close(sim->trace);
+    free(sim);
+}
+
+int sdes_inject_event(SdesSim *sim, uint64_t time, SdesTask task, void *context) {
+    return schedule_event(sim, time, EVENT_CUSTOM, task, context, NULL);
+}
+
+int sdes_inject_packet(SdesSim *sim, uint64_t time, uint64_t size) {
+    if (!sim)
+        return -1;
+    Packet *pkt = packet_create(++sim->packets_injected, time, size);
+    if (!pkt)
+        return -1;
+    if (schedule_event(sim, time, EVENT_PACKET_RECEIVED, network_task, sim->network, pkt) != 0) {
+        packet_destroy(pkt);
+        return -1;
+    }
+    return 0;
+}
+
+static uint64_t sim_run(SdesSim *sim, uint64_t until_time, uint64_t max_events) {
+    if (!sim)
+        return 0;
+    SavedGlobals saved;
+    sim_enter(sim, &saved);
+    sim->running = 1;
+    uint64_t processed = event_loop_run_until(sim->scheduler, until_time, max_events);
+    sim->running = 0;
+    sim_leave(sim, &saved);
+    sim->events_processed += processed;
+    return processed;
+}
+
+uint64_t sdes_run_until(SdesSim *sim, uint64_t until_time) {
+    return sim_run(sim, until_time, 0);
+}
+
+uint64_t sdes_run_events(SdesSim *sim, uint64_t max_events) {
+    if (max_events == 0)
+        return 0;
+    return sim_run(sim, UINT64_MAX, max_events);
+}
+
+uint64_t sdes_run(SdesSim *sim) {
+    return sim_run(sim, UINT64_MAX, 0);
+}
+
+void sdes_pause(SdesSim *sim) {
+    (void)sim;    // only one simulation runs at a time, so this is the one
+    event_loop_stop();
+}
+
+uint64_t sdes_now(const SdesSim *sim) {
+    return sim ? sdes_clock(sim) : 0;
+}
+
+int sdes_get_stats_sized(const SdesSim *sim, SdesStats *user_stats, size_t size) {
+    if (!sim || !user_stats || size < SDES_STATS_SIZE_MIN || size > sizeof(SdesStats))
+        return -1;
+    SdesStats full;
+    SdesStats *stats = &full;
+    stats->size = size;
+    stats->sim_time = sdes_clock(sim);
+    stats->events_processed = sim->events_processed;
+    stats->pending_events = sim->scheduler->size;
+    stats->packets_sent = sim->sender->packets_sent;
+    stats->total_bytes_sent = sim->sender->total_bytes_sent;
+    stats->packets_forwarded = sim->network->packets_forwarded;
+    stats->total_bytes_forwarded = sim->network->total_bytes_forwarded;
+    stats->packets_received = sim->receiver->packets_received;
+    stats->total_bytes_received = sim->receiver->total_bytes_received;
+    stats->total_latency = sim->receiver->total_latency;
+    stats->last_latency = sim->receiver->last_latency;
+    stats->packets_injected = sim->packets_injected;
+    memcpy(user_stats, stats, size);
+    return 0;
+}
+
+SdesDistribution *sdes_distribution_load_histogram(const char *path) { return distribution_load_histogram(path); }
+SdesDistribution *sdes_distribution_exponential(double mean) { return distribution_create_exponential(mean); }
+SdesDistribution *sdes_distribution_pareto(double scale, double shape) { return distribution_create_pareto(scale, shape); }
+SdesDistribution *sdes_distribution_lognormal(double mu, double sigma) { return distribution_create_lognormal(mu, sigma); }
+SdesDistribution *sdes_distribution_weibull(double scale, double shape) { return distribution_create_weibull(scale, shape); }
+void sdes_distribution_destroy(SdesDistribution *dist) { distribution_destroy(dist); }
@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "splitting.h"
+#include "event.h"
+#include "event_scheduler.h"
+#include "event_loop.h"
+
+#define SPLIT_TICKS 1000000.0    // scheduler ticks per model time unit (the scheduler works in integers)
+
+typedef enum {
+    BRANCH_RUNNING,
+    BRANCH_UP,    // crossed the next threshold, waiting to be split
+    BRANCH_DONE    // fell below kill_below (or emptied the queue)
+} BranchStatus;
+
+typedef struct SplitRun {
+    const SplitConfig *cfg;
+    uint32_t *thresholds;    // thresholds[1..m], thresholds[0] = 0
+    uint32_t m;
+    uint64_t hits;
+    uint64_t trajectories;
+    uint64_t events;
+    int failed;    // a clone could not be allocated
+} SplitRun;
+
+// the whole state of one trajectory: the queue and its own scheduler
+typedef struct SplitQueue {
+    SplitRun *run;
+    EventScheduler *scheduler;
+    uint32_t occupancy;    // the importance function
+    uint32_t level;    // highest i with occupancy >= thresholds[i]
+    uint32_t kill_below;    // the trajectory ends when occupancy drops below this
+    uint64_t now;    // clock of this trajectory while another one runs
+    BranchStatus status;
+} SplitQueue;
+
+static void arrival_task(void *context);
+static void departure_task(void *context);
+
+static uint64_t exponential_ticks(double rate) {
+    double u = (double)rand() / ((double)RAND_MAX + 1.0);
+    return (uint64_t)llround(-log(1.0 - u) / rate * SPLIT_TICKS);
+}
+
+static int schedule(SplitQueue *q, double rate, EventType type, EventTask task) {
+    Event *ev = event_create(current_sim_time + exponential_ticks(rate), type, task, q, NULL);
+    if (!ev || event_scheduler_push(q->scheduler, ev) != 0) {
+        event_destroy(ev);
+        q->run->failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+/* an arrival...
+* 1. Adds a packet and schedules the next arrival.
+* 2. If the occupancy reaches the next threshold, moves up a level and stops the loop so the driver can split.
+*/
+static void arrival_task(void *context) {
+    SplitQueue *q = (SplitQueue *)context;
+    q->occupancy++;
+    schedule(q, q->run->cfg->lambda, EVENT_PACKET_RECEIVED, arrival_task);
+
+    if (q->occupancy >= q->run->thresholds[q->level + 1]) {
+        q->level++;
+        q->status = BRANCH_UP;
+        event_loop_stop();
+    }
+}
+
+/* a departure...
+* 1. Removes a packet and moves down as many levels as needed.
+* 2. Ends the trajectory if it fell below the threshold it was born at (RESTART) or the queue is empty;
+*    otherwise schedules the next departure.
+*/
+static void departure_task(void *context) {
+    SplitQueue *q = (SplitQueue *)context;
+    q->occupancy--;
+    while (q->level > 0 && q->occupancy < q->run->thresholds[q->level])
+        q->level--;
+
+    if (q->occupancy < q->kill_below) {
+        q->status = BRANCH_DONE;
+        event_loop_stop();
+        return;
+    }
+    schedule(q, q->run->cfg->mu, EVENT_TIMEOUT, departure_task);
+}
+
+static void split_queue_destroy(SplitQueue *q) {
+    if (!q)
+        return;
+    event_scheduler_clear(q->scheduler);
+    event_scheduler_destroy(q->scheduler);
+    free(q);
+}
+
+typedef struct {
+    SplitQueue *from;
+    SplitQueue *to;
+} ClonePair;
+
+static void *remap_queue(void *context, void *arg) {
+    ClonePair *pair = (ClonePair *)arg;
+    return context == pair->from ? pair->to : context;
+}
+
+// clone the simulation state: queue fields plus every pending event, pointed at the copy
+static SplitQueue *split_queue_clone(SplitQueue *q) {
+    SplitQueue *copy = malloc(sizeof(SplitQueue));
+    if (!copy)
+        return NULL;
+    *copy = *q;
+    ClonePair pair = { q, copy };
+    copy->scheduler = event_scheduler_clone(q->scheduler, remap_queue, &pair);
+    if (!copy->scheduler) {
+        free(copy);
+        return NULL;
+    }
+    return copy;
+}
+
+/* runs one trajectory to its end, splitting it on the way...
+* 1. Runs the trajectory's scheduler until a task stops it (threshold crossed, or trajectory over).
+* 2. On a crossing of the top threshold, counts a hit and ends the trajectory.
+* 3. On any other crossing, runs splits - 1 clones (depth first) that die below the threshold just crossed,
+*    then the original carries on from step 1.
+*/
+static void run_branch(SplitRun *run, SplitQueue *q) {
+    for (;;) {
+        current_sim_time = q->now;
+        run->events += event_loop_run_until(q->scheduler, UINT64_MAX, 0);
+        q->now = current_sim_time;
+
+        if (q->status != BRANCH_UP)
+            return;
+        q->status = BRANCH_RUNNING;
+
+        if (q->level == run->m) {
+            run->hits++;
+            return;
+        }
+
+        for (uint32_t r = 1; r < run->cfg->splits; r++) {
+            SplitQueue *retrial = split_queue_clone(q);
+            if (!retrial) {
+                run->failed = 1;
+                return;
+            }
+            retrial->kill_below = run->thresholds[q->level];
+            run->trajectories++;
+            run_branch(run, retrial);
+            split_queue_destroy(retrial);
+        }
+    }
+}
+
+// gambler's ruin: probability to reach buffer before 0 starting from 1, up-step odds lambda : mu
+static double analytic_overflow(double lambda, double mu, uint32_t buffer) {
+    double r = mu / lambda;
+    if (fabs(r - 1.0) < 1e-12)
+        return 1.0 / buffer;
+    return (1.0 - r) / (1.0 - pow(r, (double)buffer));
+}
+
+/* the estimator...
+* 1. Places the thresholds T_i = 1 + i * (buffer - 1) / m, so T_m = buffer.
+* 2. For each root: a fresh queue with one packet, one pending arrival and one departure, run by run_branch.
+* 3. The root's contribution is hits * splits^-(m-1); mean and sample variance over the roots give the
+*    estimate and its variance.
+*/
+int restart_estimate(const SplitConfig *cfg, SplitResult *result) {
+    if (!cfg || !result || cfg->lambda <= 0.0 || cfg->mu <= 0.0 || cfg->buffer < 2 ||
+        cfg->splits < 1 || cfg->roots == 0)
+        return -1;
+
+    SplitRun run = { 0 };
+    run.cfg = cfg;
+    run.m = cfg->n_levels;
+    if (run.m == 0 || run.m > cfg->buffer - 1)
+        run.m = cfg->buffer - 1;
+    run.thresholds = malloc(sizeof(uint32_t) * (run.m + 2));
+    if (!run.thresholds)
+        return -1;
+    run.thresholds[0] = 0;
+    for (uint32_t i = 1; i <= run.m; i++)
+        run.thresholds[i] = 1 + (uint32_t)((uint64_t)i * (cfg->buffer - 1) / run.m);
+    run.thresholds[run.m + 1] = UINT32_MAX;
+
+    if (cfg->seed)
+        srand(cfg->seed);
+    double weight = pow((double)cfg->splits, -(double)(run.m - 1));
+    double sum = 0.0, sum_sq = 0.0;
+    uint64_t roots = 0;
+    uint64_t saved_time = current_sim_time;
+
+    while (roots < cfg->roots && !run.failed && (cfg->max_events == 0 || run.events < cfg->max_events)) {
+        SplitQueue *q = calloc(1, sizeof(SplitQueue));
+        if (!q || !(q->scheduler = event_scheduler_create(4))) {
+            free(q);
+            run.failed = 1;
+            break;
+        }
+        q->run = &run;
+        q->occupancy = 1;
+        q->kill_below = 1;
+        current_sim_time = 0;
+        schedule(q, cfg->lambda, EVENT_PACKET_RECEIVED, arrival_task);
+        schedule(q, cfg->mu, EVENT_TIMEOUT, departure_task);
+        run.trajectories++;
+
+        uint64_t hits_before = run.hits;
+        run_branch(&run, q);
+        split_queue_destroy(q);
+
+        double contribution = (double)(run.hits - hits_before) * weight;
+        sum += contribution;
+        sum_sq += contribution * contribution;
+        roots++;
+    }
+    current_sim_time = saved_time;
+    free(run.thresholds);
+
+    if (run.failed || roots == 0)
+        return -1;
+
+    double mean = sum / roots;
+    result->estimate = mean;
+    result->variance = roots > 1 ? (sum_sq - roots * mean * mean) / (roots - 1) / roots : 0.0;
+    if (result->variance < 0.0)
+        result->variance = 0.0;
+    result->relative_error = mean > 0.0 ? sqrt(result->variance) / mean : INFINITY;
+    result->analytic = analytic_overflow(cfg->lambda, cfg->mu, cfg->buffer);
+    result->roots = roots;
+    result->hits = run.hits;
+    result->trajectories = run.trajectories;
+    result->events = run.events;
+    return 0;
+}
+
+void restart_print_result(const char *label, const SplitConfig *cfg, const SplitResult *result) {
+    printf("\n=== %s ===\n", label);
+    printf("  Model: M/M/1/K lambda=%.4f mu=%.4f buffer=%u\n", cfg->lambda, cfg->mu, cfg->buffer);
+    printf("  Splits per crossing: %u\n", cfg->splits);
+    printf("  Busy cycles: %llu\n", (unsigned long long)result->roots);
+    printf("  Trajectories: %llu\n", (unsigned long long)result->trajectories);
+    printf("  Events: %llu\n", (unsigned long long)result->events);
+    printf("  Overflow hits: %llu\n", (unsigned long long)result->hits);
+    printf("  Overflow probability per cycle: %.4e\n", result->estimate);
+    if (result->estimate > 0.0) {
+        double se = sqrt(result->variance);
+        printf("  Standard error: %.4e (relative %.2f%%)\n", se, 100.0 * result->relative_error);
+        printf("  95%% confidence interval: [%.4e, %.4e]\n", result->estimate - 1.96 * se, result->estimate + 1.96 * se);
+    } else {
+        printf("  Standard error: n/a (no overflow observed)\n");
+    }
+    printf("  Analytic value: %.4e\n", result->analytic);
+}
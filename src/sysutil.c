@@ -0,0 +1,11 @@
+#include <unistd.h>
+#include "sysutil.h"
+
+size_t sys_page_size(void) {
+    static size_t cached = 0;
+    if (!cached) {
+        long ps = sysconf(_SC_PAGESIZE);
+        cached = ps > 0 ? (size_t)ps : 4096;
+    }
+    return cached;
+}
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+#include "sysutil.h"
+
+// byte offset of record idx inside the mapping
+static size_t record_offset(uint64_t idx) {
+    return sizeof(TraceHeader) + (size_t)idx * sizeof(TraceRecord);
+}
+
+/* the readahead part...
+* 1. Hints the kernel to fetch the next window of records (MADV_WILLNEED) before the cursor gets there.
+* 2. Hands back the pages more than one window behind the cursor (MADV_DONTNEED), so resident memory
+*    stays at a couple of windows no matter how long the trace is. The mapping is read-only and file backed,
+*    so dropped pages are simply re-read if anyone looks at them again.
+*/
+static void trace_advise(TraceFile *trace) {
+    size_t ps = sys_page_size();
+    char *base = (char *)trace->map;
+
+    if (trace->advised_until < trace->count) {
+        uint64_t end = trace->advised_until + TRACE_READAHEAD_RECORDS;
+        if (end > trace->count)
+            end = trace->count;
+        size_t from = record_offset(trace->advised_until) & ~(ps - 1);
+        size_t to = record_offset(end);
+        madvise(base + from, to - from, MADV_WILLNEED);
+        trace->advised_until = end;
+    }
+
+    if (trace->cursor > TRACE_READAHEAD_RECORDS) {
+        uint64_t behind = trace->cursor - TRACE_READAHEAD_RECORDS;
+        size_t from = record_offset(trace->released_until) & ~(ps - 1);
+        size_t to = record_offset(behind) & ~(ps - 1);
+        if (to > from) {
+            madvise(base + from, to - from, MADV_DONTNEED);
+            trace->released_until = behind;
+        }
+    }
+}
+
+TraceFile *trace_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader)) {
+        fprintf(stderr, "[Trace] %s: not a trace file\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return NULL;
+    }
+
+    const TraceHeader *hdr = (const TraceHeader *)map;
+    // compare counts, not byte offsets: a huge count would wrap record_offset around
+    if (memcmp(hdr->magic, TRACE_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->count > ((size_t)st.st_size - sizeof(TraceHeader)) / sizeof(TraceRecord)) {
+        fprintf(stderr, "[Trace] %s: bad header or truncated file\n", path);
+        munmap(map, (size_t)st.st_size);
+        close(fd);
+        return NULL;
+    }
+
+    TraceFile *trace = malloc(sizeof(TraceFile));
+    if (!trace) {
+        munmap(map, (size_t)st.st_size);
+        close(fd);
+        return NULL;
+    }
+    trace->fd = fd;
+    trace->map = map;
+    trace->map_len = (size_t)st.st_size;
+    trace->records = (const TraceRecord *)((const char *)map + sizeof(TraceHeader));
+    trace->count = hdr->count;
+    trace->cursor = 0;
+    trace->advised_until = 0;
+    trace->released_until = 0;
+
+    madvise(map, trace->map_len, MADV_SEQUENTIAL);
+    trace_advise(trace);
+    return trace;
+}
+
+void trace_close(TraceFile *trace) {
+    if (!trace)
+        return;
+    munmap(trace->map, trace->map_len);
+    close(trace->fd);
+    free(trace);
+}
+
+const TraceRecord *trace_peek(TraceFile *trace) {
+    if (!trace || trace->cursor >= trace->count)
+        return NULL;
+    return &trace->records[trace->cursor];
+}
+
+const TraceRecord *trace_next(TraceFile *trace) {
+    if (!trace || trace->cursor >= trace->count)
+        return NULL;
+    const TraceRecord *rec = &trace->records[trace->cursor++];
+    if (trace->cursor + TRACE_READAHEAD_RECORDS / 2 >= trace->advised_until &&
+        (trace->cursor & (TRACE_READAHEAD_RECORDS / 2 - 1)) == 0)
+        trace_advise(trace);
+    return rec;
+}
+
+static int is_blank(const char *line) {
+    while (*line && isspace((unsigned char)*line))
+        line++;
+    return *line == '\0';
+}
+
+static const char *parse_u64(const char *p, unsigned long long *value) {
+    if (!isdigit((unsigned char)*p))
+        return NULL;    // strtoull would also take signs and leading blanks
+    char *end;
+    errno = 0;
+    *value = strtoull(p, &end, 10);
+    return errno ? NULL : end;
+}
+
+// "timestamp,size" with optional blanks around the comma and trailing whitespace; 0 on success
+static int parse_record_line(const char *line, unsigned long long *time, unsigned long long *size) {
+    const char *p = parse_u64(line, time);
+    if (!p)
+        return -1;
+    while (*p == ' ' || *p == '\t')
+        p++;
+    if (*p++ != ',')
+        return -1;
+    while (*p == ' ' || *p == '\t')
+        p++;
+    if (!(p = parse_u64(p, size)))
+        return -1;
+    return is_blank(p) ? 0 : -1;
+}
+
+/* the converter...
+* 1. Writes a placeholder header, then one record per "timestamp,size" line.
+* 2. Skips blank lines, '#' comments and one header line (the first line, if it starts with a letter).
+*    Any other line that is not a valid record is an error with its line number: a captured trace must not
+*    lose data silently.
+* 3. Refuses unsorted timestamps: the replay is strictly sequential and cannot sort billions of records.
+* 4. Rewrites the header with the final count; on error the partial output is removed.
+*/
+int64_t trace_convert_csv(const char *csv_path, const char *bin_path) {
+    FILE *in = fopen(csv_path, "r");
+    if (!in) {
+        perror(csv_path);
+        return -1;
+    }
+    FILE *out = fopen(bin_path, "wb");
+    if (!out) {
+        perror(bin_path);
+        fclose(in);
+        return -1;
+    }
+
+    TraceHeader hdr;
+    memcpy(hdr.magic, TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.count = 0;
+    fwrite(&hdr, sizeof(hdr), 1, out);
+
+    char line[256];
+    uint64_t line_no = 0;
+    uint64_t last_time = 0;
+    int64_t result = -1;
+
+    while (fgets(line, sizeof(line), in)) {
+        line_no++;
+        if (!strchr(line, '\n') && !feof(in)) {
+            fprintf(stderr, "[Trace] %s:%llu: line too long\n", csv_path, (unsigned long long)line_no);
+            goto done;
+        }
+        if (is_blank(line) || line[0] == '#')
+            continue;
+        if (line_no == 1 && isalpha((unsigned char)line[0]))
+            continue;    // column names
+
+        unsigned long long time, size;
+        if (parse_record_line(line, &time, &size) != 0) {
+            fprintf(stderr, "[Trace] %s:%llu: expected 'timestamp,size'\n", csv_path, (unsigned long long)line_no);
+            goto done;
+        }
+        if (hdr.count > 0 && time < last_time) {
+            fprintf(stderr, "[Trace] %s:%llu: timestamps must be sorted\n", csv_path, (unsigned long long)line_no);
+            goto done;
+        }
+
+        TraceRecord rec = { time, size };
+        if (fwrite(&rec, sizeof(rec), 1, out) != 1) {
+            perror(bin_path);
+            goto done;
+        }
+        last_time = time;
+        hdr.count++;
+    }
+
+    if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&hdr, sizeof(hdr), 1, out) != 1) {
+        perror(bin_path);
+        goto done;
+    }
+    result = (int64_t)hdr.count;
+
+done:
+    fclose(in);
+    if (fclose(out) != 0)
+        result = -1;
+    if (result < 0)
+        remove(bin_path);
+    return result;
+}